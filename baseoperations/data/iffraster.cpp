@@ -31,7 +31,7 @@ bool IffRaster::execute(ExecutionContext *ctx, SymbolTable& symTable)
         if((_prepState = prepare(ctx, symTable)) != sPREPARED)
             return false;
 
-    BoxedAsyncFunc iffunc = [&](const BoundingBox& box) -> bool {
+    BoxedStatisticsFunc iffunc = [&](const BoundingBox& box, NumericStatistics::Partial& markers) -> bool {
 
         PixelIterator iterOut(_outputGC,box);
         PixelIterator iterIn(_inputGC,box);
@@ -59,6 +59,7 @@ bool IffRaster::execute(ExecutionContext *ctx, SymbolTable& symTable)
                 v2 = _number[1];
 
             *iterOut = *iterIn ? v1 : v2;
+            markers(*iterOut);
 
             ++iterOut;
             ++iterIn;
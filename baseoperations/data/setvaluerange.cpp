@@ -49,7 +49,7 @@ bool SetValueRange::execute(ExecutionContext *ctx, SymbolTable &symTable)
         }
         _table->column(_columnName, data);
     } else {
-        std::function<bool(const BoundingBox)> SetValrange = [&](const BoundingBox box ) -> bool {
+        BoxedStatisticsFunc SetValrange = [&](const BoundingBox& box, NumericStatistics::Partial& markers) -> bool {
             PixelIterator iter(_raster, box);
 
             std::for_each(iter, iter.end(), [&](double& val){
@@ -57,6 +57,7 @@ bool SetValueRange::execute(ExecutionContext *ctx, SymbolTable &symTable)
                 if (!defaultMinmaxUsed && lstep != 0){
                     val = rngDomain->min() + lstep * ((qint64)(val - rngDomain->min()) / lstep);
                 }
+                markers(val);
             });
             return true;
         };
@@ -1,5 +1,6 @@
 #include <functional>
 #include <future>
+#include <cmath>
 #include "kernel.h"
 #include "raster.h"
 #include "symboltable.h"
@@ -27,6 +28,92 @@ ResampleRaster::ResampleRaster(quint64 metaid, const Ilwis::OperationExpression
 {
 }
 
+ResampleTransform::ResampleTransform(const IRasterCoverage &inputRaster, const IRasterCoverage &outputRaster, double tolerance) :
+    _inputGrf(inputRaster->georeference()),
+    _outputGrf(outputRaster->georeference()),
+    _inputCsy(inputRaster->coordinateSystem()),
+    _outputCsy(outputRaster->coordinateSystem()),
+    _tolerance(tolerance)
+{
+    _equalCsy = _inputCsy->isEqual(_outputCsy.ptr());
+}
+
+void ResampleTransform::exact(const std::vector<double> &xs, double y, std::vector<Pixeld> &result)
+{
+    quint32 count = xs.size();
+    result.resize(count);
+    if ( count == 0)
+        return;
+    std::vector<double> crdx(count), crdy(count);
+    // runs of neighbouring pixels are mapped as one row, the georeference can step along it
+    quint32 start = 0;
+    while ( start < count) {
+        quint32 end = start + 1;
+        while ( end < count && xs[end] == xs[end - 1] + 1)
+            ++end;
+        _outputGrf->pixel2Coord(xs[start], y, end - start, &crdx[start], &crdy[start]);
+        start = end;
+    }
+    if ( !_equalCsy)
+        _inputCsy->coord2coord(_outputCsy, &crdx[0], &crdy[0], count);
+    _inputGrf->coord2Pixel(&crdx[0], &crdy[0], count, &crdx[0], &crdy[0]);
+    for(quint32 i = 0; i < count; ++i)
+        result[i] = Pixeld(crdx[i], crdy[i]);
+}
+
+void ResampleTransform::line(qint32 y, qint32 xstart, qint32 xend, std::vector<Pixeld> &pixels)
+{
+    qint32 length = xend - xstart + 1;
+    pixels.resize(length);
+    _xs.clear();
+    if ( _tolerance <= 0 || length <= 2) {
+        for(qint32 x = xstart; x <= xend; ++x)
+            _xs.push_back(x);
+        exact(_xs, y, pixels);
+        return;
+    }
+
+    // the nodes of the mesh (the last pixel is always one) and the middles between them, each in one batch
+    for(qint32 x = xstart; x < xend; x += MESHSTEP)
+        _xs.push_back(x);
+    _xs.push_back(xend);
+    exact(_xs, y, _nodes);
+    for(quint32 i = 0; i + 1 < _xs.size(); ++i)
+        _xs[i] = (_xs[i] + _xs[i + 1]) / 2.0;
+    _xs.pop_back();
+    exact(_xs, y, _middles);
+
+    std::vector<double> redo;
+    for(quint32 i = 0; i < _middles.size(); ++i) {
+        qint32 x1 = xstart + i * MESHSTEP;
+        qint32 x2 = std::min(x1 + MESHSTEP, xend);
+        const Pixeld& p1 = _nodes[i];
+        const Pixeld& p2 = _nodes[i + 1];
+        const Pixeld& middle = _middles[i];
+        bool linear = p1.isValid() && p2.isValid() && middle.isValid() &&
+                std::abs((p1.x + p2.x) / 2.0 - middle.x) <= _tolerance &&
+                std::abs((p1.y + p2.y) / 2.0 - middle.y) <= _tolerance;
+        if ( linear) {
+            double dx = (p2.x - p1.x) / (x2 - x1);
+            double dy = (p2.y - p1.y) / (x2 - x1);
+            for(qint32 x = x1; x < x2; ++x)
+                pixels[x - xstart] = Pixeld(p1.x + (x - x1) * dx, p1.y + (x - x1) * dy);
+        } else {
+            for(qint32 x = x1; x < x2; ++x)
+                redo.push_back(x);
+        }
+    }
+    pixels[length - 1] = _nodes.back();
+
+    if ( redo.size() > 0) {
+        std::vector<Pixeld> exactPixels;
+        exact(redo, y, exactPixels);
+        for(quint32 i = 0; i < redo.size(); ++i)
+            pixels[(qint32)redo[i] - xstart] = exactPixels[i];
+    }
+}
+
+//-------------------------------------------------------
 bool ResampleRaster::execute(ExecutionContext *ctx, SymbolTable& symTable)
 {
     if (_prepState == sNOTPREPARED)
@@ -35,18 +122,37 @@ bool ResampleRaster::execute(ExecutionContext *ctx, SymbolTable& symTable)
     IRasterCoverage outputRaster = _outputObj.as<RasterCoverage>();
     IRasterCoverage inputRaster = _inputObj.as<RasterCoverage>();
 
+    // the positions in the input are computed once per output line and used for all bands
     BoxedAsyncFunc resampleFun = [&](const BoundingBox& box) -> bool {
-        PixelIterator iterOut(outputRaster,box);
         RasterInterpolator interpolator(inputRaster, _method);
-        PixelIterator iterEnd = iterOut.end();
-        bool equalCsy = inputRaster->coordinateSystem()->isEqual(outputRaster->coordinateSystem().ptr());
-        while(iterOut != iterEnd) {
-            Pixel position = iterOut.position();
-            Coordinate coord = outputRaster->georeference()->pixel2Coord(Pixeld(position.x,(position.y)));
-            if ( !equalCsy)
-                coord = inputRaster->coordinateSystem()->coord2coord(outputRaster->coordinateSystem(),coord);
-            *iterOut = interpolator.coord2value(coord, iterOut.position().z);
-            ++iterOut;
+        ResampleTransform transform(inputRaster, outputRaster, _tolerance);
+        std::vector<PixelIterator> bandIters;
+        qint32 zmax = std::min((qint32)box.max_corner().z, (qint32)outputRaster->size().zsize() - 1);
+        for(qint32 z = box.min_corner().z; z <= zmax; ++z) {
+            BoundingBox bandBox(Pixel(box.min_corner().x, box.min_corner().y, z), Pixel(box.max_corner().x, box.max_corner().y, z));
+            bandIters.push_back(PixelIterator(outputRaster, bandBox));
+        }
+        std::vector<Pixeld> pixels;
+        for(qint32 y = box.min_corner().y; y <= box.max_corner().y; ++y) {
+            transform.line(y, box.min_corner().x, box.max_corner().x, pixels);
+            for(quint32 band = 0; band < bandIters.size(); ++band) {
+                PixelIterator& iterOut = bandIters[band];
+                qint32 z = box.min_corner().z + band;
+                quint32 index = 0;
+                while(index < pixels.size()) {
+                    auto out = iterOut.span();
+                    qint64 cells = std::min((qint64)(pixels.size() - index), (qint64)(out.second - out.first));
+                    if ( cells == 0)
+                        return false;
+                    for(qint64 i = 0; i < cells; ++i) {
+                        Pixeld pix = pixels[index + i];
+                        pix.z = z;
+                        out.first[i] = pix.isValid() ? interpolator.pix2value(pix) : rUNDEF;
+                    }
+                    index += cells;
+                    iterOut += cells;
+                }
+            }
         }
         return true;
     };
@@ -111,6 +217,15 @@ Ilwis::OperationImplementation::State ResampleRaster::prepare(ExecutionContext *
         return sPREPAREFAILED;
     }
 
+    if ( _expression.parameterCount() == 4) {
+        bool ok;
+        _tolerance = _expression.parm(3).value().toDouble(&ok);
+        if ( !ok || _tolerance < 0) {
+            ERROR3(ERR_ILLEGAL_PARM_3,"tolerance",_expression.parm(3).value(),"resample");
+            return sPREPAREFAILED;
+        }
+    }
+
     return sPREPARED;
 }
 
@@ -119,12 +234,13 @@ quint64 ResampleRaster::createMetadata()
 
     OperationResource operation({"ilwis://operations/resample"});
     operation.setLongName("Resample Raster");
-    operation.setSyntax("resample(inputgridcoverage,targetgeoref,nearestneighbour|bilinear|!bicubic)");
+    operation.setSyntax("resample(inputgridcoverage,targetgeoref,nearestneighbour|bilinear|!bicubic[,tolerance])");
     operation.setDescription(TR("translates a rastercoverage from one geometry (coordinatesystem+georeference) to another"));
-    operation.setInParameterCount({3});
+    operation.setInParameterCount({3,4});
     operation.addInParameter(0,itRASTER, TR("input rastercoverage"),TR("input rastercoverage with domain any domain"));
     operation.addInParameter(1,itGEOREF,  TR("target georeference"),TR("the georeference to which the input coverage will be morphed"));
     operation.addInParameter(2,itSTRING, TR("Resampling method"),TR("The method used to aggregate pixels from the input map in the geometry of the output map") );
+    operation.addInParameter(3,itDOUBLE, TR("tolerance"),TR("optional maximum error (in input pixels) of the interpolated transformation between exactly computed points; 0 computes every pixel exactly, the default is 0.125") );
     operation.setOutParameterCount({1});
     operation.addOutParameter(0,itRASTER, TR("output rastercoverage"), TR("output rastercoverage with the domain of the input map"));
     operation.setKeywords("raster, geometry, transformation");
@@ -3,6 +3,41 @@
 
 namespace Ilwis {
 namespace BaseOperations {
+
+/*!
+ * \brief The ResampleTransform class maps the pixels of an output line to (fractional) pixel positions in the input raster
+ *
+ * The exact mapping (output georeference, coordinate transformation, input georeference) is evaluated for a whole line at once, but only
+ * on a coarse mesh of nodes and at the middles between them. Where the middle lies within the tolerance (in input pixels) of the
+ * linear interpolation between its nodes, the pixels in between are interpolated; elsewhere they are evaluated exactly. This is
+ * the approximate transformer of GDAL in a batched form. A tolerance of 0 evaluates every pixel exactly.
+ */
+class ResampleTransform {
+public:
+    ResampleTransform(const IRasterCoverage& inputRaster, const IRasterCoverage& outputRaster, double tolerance);
+
+    /*!
+     * \brief line computes the input positions of output pixels xstart..xend of line y
+     * \param pixels receives xend - xstart + 1 positions; positions that can not be transformed are invalid
+     */
+    void line(qint32 y, qint32 xstart, qint32 xend, std::vector<Pixeld>& pixels);
+
+private:
+    static const qint32 MESHSTEP = 32;
+
+    void exact(const std::vector<double>& xs, double y, std::vector<Pixeld>& result);
+
+    IGeoReference _inputGrf;
+    IGeoReference _outputGrf;
+    ICoordinateSystem _inputCsy;
+    ICoordinateSystem _outputCsy;
+    bool _equalCsy;
+    double _tolerance;
+    std::vector<double> _xs;
+    std::vector<Pixeld> _nodes;
+    std::vector<Pixeld> _middles;
+};
+
 class ResampleRaster : public OperationImplementation
 {
 public:
@@ -21,6 +56,7 @@ private:
     IIlwisObject _outputObj;
     IGeoReference _targetGrf;
     Ilwis::RasterInterpolator::InterpolationMethod _method;
+    double _tolerance = 0.125;
 
     NEW_OPERATION(ResampleRaster);
 
@@ -37,7 +37,7 @@ bool BinaryLogical::executeCoverageNumber(ExecutionContext *ctx, SymbolTable& sy
 
     auto BinaryLogical = [&](const BoundingBox box ) -> bool {
         PixelIterator iterIn(_inputGC1, box);
-        PixelIterator iterOut(_outputGC, BoundingBox(box.size()));
+        PixelIterator iterOut(_outputGC, box);
 
         std::for_each(iterOut, iterOut.end(), [&](double& v){
             double v_in1 = *iterIn;
@@ -62,7 +62,7 @@ bool BinaryLogical::executeCoverageCoverage(ExecutionContext *ctx, SymbolTable&
     std::function<bool(const BoundingBox&)> binaryLogical = [&](const BoundingBox& box ) -> bool {
         PixelIterator iterIn1(_inputGC1, box);
         PixelIterator iterIn2(_inputGC2, box);
-        PixelIterator iterOut(_outputGC, BoundingBox(box.size()));
+        PixelIterator iterOut(_outputGC, box);
 
         double v_in1 = 0;
         double v_in2 = 0;
@@ -36,21 +36,26 @@ bool BinaryMathRaster::setOutput(ExecutionContext *ctx, SymbolTable& symTable) {
 
 bool BinaryMathRaster::executeCoverageNumber(ExecutionContext *ctx, SymbolTable& symTable) {
 
-    quint64 currentCount = 0;
-    auto binaryMath = [&](const BoundingBox box ) -> bool {
+    BoxedStatisticsFunc binaryMath = [&](const BoundingBox& box, NumericStatistics::Partial& markers) -> bool {
         PixelIterator iterIn(_inputGC1, box);
-        PixelIterator iterOut(_outputGC, BoundingBox(box.size()));
-
-        std::for_each(iterOut, iterOut.end(), [&](double& v){
+        PixelIterator iterOut(_outputGC, box);
 
-            v = _firstorder ? calc(_number1, *iterIn) : calc(*iterIn, _number1);
-            ++iterIn;
-            updateTranquilizer(currentCount++, 1000);
-        });
+        PixelIterator iterEnd = end(iterOut);
+        while(iterOut != iterEnd) {
+            auto in = iterIn.span();
+            auto out = iterOut.span();
+            int cells = std::min(in.second - in.first, out.second - out.first);
+            if ( cells == 0)
+                break;
+            calc(_number1, in.first, out.first, cells, _firstorder);
+            std::for_each(out.first, out.first + cells, std::ref(markers));
+            iterIn += cells;
+            iterOut += cells;
+            trq().update(cells);
+        }
         return true;
     };
 
-    ctx->_threaded = false;
     if (!OperationHelperRaster::execute(ctx, binaryMath, _outputGC))
             return false;
 
@@ -60,19 +65,25 @@ bool BinaryMathRaster::executeCoverageNumber(ExecutionContext *ctx, SymbolTable&
 }
 
 bool BinaryMathRaster::executeCoverageCoverage(ExecutionContext *ctx, SymbolTable& symTable) {
-    quint64 currentCount = 0;
-    std::function<bool(const BoundingBox)> binaryMath = [&](const BoundingBox box ) -> bool {
+    BoxedStatisticsFunc binaryMath = [&](const BoundingBox& box, NumericStatistics::Partial& markers) -> bool {
         PixelIterator iterIn1(_inputGC1, box);
         PixelIterator iterIn2(_inputGC2, box);
         PixelIterator iterOut(_outputGC, box);
 
         PixelIterator iterEnd = end(iterOut);
         while(iterOut != iterEnd) {
-            *iterOut = calc(*iterIn1, *iterIn2);
-            ++iterIn1;
-            ++iterIn2;
-            ++iterOut;
-            updateTranquilizer(currentCount++, 1000);
+            auto in1 = iterIn1.span();
+            auto in2 = iterIn2.span();
+            auto out = iterOut.span();
+            int cells = std::min(std::min(in1.second - in1.first, in2.second - in2.first), out.second - out.first);
+            if ( cells == 0)
+                break;
+            calc(in1.first, in2.first, out.first, cells);
+            std::for_each(out.first, out.first + cells, std::ref(markers));
+            iterIn1 += cells;
+            iterIn2 += cells;
+            iterOut += cells;
+            trq().update(cells);
         };
         return true;
     };
@@ -82,10 +93,8 @@ bool BinaryMathRaster::executeCoverageCoverage(ExecutionContext *ctx, SymbolTabl
             return ERROR2(ERR_COULD_NOT_CONVERT_2, TR("georeferences"), TR("common base"));
         }
     }
-    // TODO:, research this exception
-    // because of the swapping mechanism it is probably detrimental to use multithread here as blocks may continously be swapping
-    //if ( _inputGC1 == _inputGC2)
-        ctx->_threaded = false;
+    // every thread walks its own range of tiles in block order and pins the blocks it works on, so threads do not make the
+    // swapping worse nor can they evict each other's blocks halfway a run
 
     if (OperationHelperRaster::execute(ctx, binaryMath, _outputGC))
         return setOutput(ctx, symTable);
@@ -45,23 +45,23 @@ bool BinaryMathTable::execute(ExecutionContext *ctx, SymbolTable &symTable)
         if((_prepState = prepare(ctx, symTable)) != sPREPARED)
             return false;
 
-    std::vector<QVariant> data1(_inputTable->recordCount(), _number1), data2(_inputTable->recordCount(), _number2),outdata(_inputTable->recordCount(), rUNDEF);
+    quint32 records = _inputTable->recordCount();
+    // the columns are read as plain arrays; no copy at all when the table stores them as doubles
+    std::vector<double> buffer1, buffer2;
+    ColumnSpan<double> values1, values2;
     if ( _column1 != sUNDEF)
-        data1 = _inputTable->column(_column1);
-
+        values1 = _inputTable->realColumn(_inputTable->columnIndex(_column1), buffer1);
     if ( _column2 != sUNDEF)
-        data2 = _inputTable->column(_column2);
-
-    auto iter1 = data1.begin();
-    auto iter2 = data2.begin();
-    std::for_each(outdata.begin(), outdata.end(),[&](QVariant& v){
-        double v_in1 = (*iter1).toDouble();
-        double v_in2 = (*iter2).toDouble();
-        v = calc(v_in1, v_in2);
-        ++iter1;
-        ++iter2;
-    });
-    _outputTable->column(_outColumn,outdata);
+        values2 = _inputTable->realColumn(_inputTable->columnIndex(_column2), buffer2);
+
+    std::vector<double> result(records, rUNDEF);
+    if ( _column1 != sUNDEF && _column2 != sUNDEF)
+        calc(values1.begin(), values2.begin(), result.data(), std::min(records, std::min(values1.size(), values2.size())));
+    else if ( _column1 != sUNDEF)
+        calc(_number2, values1.begin(), result.data(), std::min(records, values1.size()), false);
+    else
+        calc(_number1, values2.begin(), result.data(), std::min(records, values2.size()), true);
+    _outputTable->realColumn(_outputTable->columnIndex(_outColumn), result.data(), result.size());
 
     if ( _outputTable.isValid()) {
         QVariant var;
@@ -17,12 +17,13 @@ UnaryMath::UnaryMath() {
 
 }
 
-UnaryMath::UnaryMath(quint64 metaid, const Ilwis::OperationExpression& expr, const QString &outpDom, UnaryFunction fun) :
+UnaryMath::UnaryMath(quint64 metaid, const Ilwis::OperationExpression& expr, const QString &outpDom, UnaryFunction fun, UnaryRunFunction runFun) :
     OperationImplementation(metaid, expr),
     _case(otSPATIAL),
     _number(rUNDEF),
     _outputDomain(outpDom),
-    _unaryFun(fun)
+    _unaryFun(fun),
+    _unaryRunFun(runFun)
 {
 
 }
@@ -34,17 +35,29 @@ bool UnaryMath::execute(ExecutionContext *ctx, SymbolTable& symTable)
             return false;
 
     if ( _case == otSPATIAL) {
-        BoxedAsyncFunc unaryFun = [&](const BoundingBox& box) -> bool {
-            PixelIterator iterIn(_inputGC, _box);
-            PixelIterator iterOut(_outputGC, BoundingBox(_box.size()));
-
-            double v_in = 0;
-            std::for_each(iterOut, iterOut.end(), [&](double& v){
-                if ( (v_in = *iterIn) != rUNDEF) {
-                    v = _unaryFun(v_in);
+        BoxedStatisticsFunc unaryFun = [&](const BoundingBox& box, NumericStatistics::Partial& markers) -> bool {
+            PixelIterator iterIn(_inputGC, box);
+            PixelIterator iterOut(_outputGC, box);
+
+            PixelIterator iterEnd = iterOut.end();
+            while(iterOut != iterEnd) {
+                auto in = iterIn.span();
+                auto out = iterOut.span();
+                int cells = std::min(in.second - in.first, out.second - out.first);
+                if ( cells == 0)
+                    break;
+                if ( _unaryRunFun)
+                    _unaryRunFun(in.first, out.first, cells);
+                else {
+                    for(int i = 0; i < cells; ++i) {
+                        if ( in.first[i] != rUNDEF)
+                            out.first[i] = _unaryFun(in.first[i]);
+                    }
                 }
-                ++iterIn;
-            });
+                std::for_each(out.first, out.first + cells, std::ref(markers));
+                iterIn += cells;
+                iterOut += cells;
+            }
             return true;
         };
 
@@ -60,14 +73,15 @@ bool UnaryMath::execute(ExecutionContext *ctx, SymbolTable& symTable)
         ctx->setOutput(symTable, QVariant(v), sUNDEF, itDOUBLE, Resource());
 
     } else if (  _case == otTABLE) {
-        std::vector<QVariant> data = _inputTable->column(_inColumn);
-        std::vector<QVariant> dataOut(data.size());
+        std::vector<double> buffer;
+        ColumnSpan<double> data = _inputTable->realColumn(_inputTable->columnIndex(_inColumn), buffer);
+        std::vector<double> dataOut(data.size());
         auto iterOut = dataOut.begin();
-        for(const QVariant& val : data) {
-            *iterOut = _unaryFun(val.toDouble());
+        for(double val : data) {
+            *iterOut = _unaryFun(val);
             ++iterOut;
         }
-        _outputTable->column(_outColumn,dataOut);
+        _outputTable->realColumn(_outputTable->columnIndex(_outColumn), dataOut.data(), dataOut.size());
         if ( _outputTable.isValid()) {
             QVariant var;
             var.setValue<ITable>(_outputTable);
@@ -5,6 +5,18 @@ namespace Ilwis {
 namespace BaseOperations{
 
 typedef std::function<double(double)> UnaryFunction;
+typedef std::function<void(const double *, double *, quint32)> UnaryRunFunction;
+
+/*!
+ * kernel applying fun to a run of cells; the function is a template argument so it is inlined in the loop and, for the simple
+ * functions, the loop is vectorized by the compiler. Undefined input gives undefined output
+ */
+template<double (*fun)(double)> void unaryRun(const double *in, double *out, quint32 count) {
+    for(quint32 i = 0; i < count; ++i) {
+        double v = in[i];
+        out[i] = v == rUNDEF ? rUNDEF : fun(v);
+    }
+}
 
 class UnaryMath : public OperationImplementation
 {
@@ -13,7 +25,7 @@ public:
     enum UnaryOperations{uoSIN, uoCOS, uoTAN, uoSQRT, uoASIN, uoACOS, uoATAN, uoLog10, uoLN, uoABS, uoCEIL,
                          uoFLOOR,uoCOSH, uoEXP, uoNEG,uoRND,uoSGN,uoSINH,uoTANH};
     UnaryMath();
-    UnaryMath(quint64 metaid, const Ilwis::OperationExpression &expr, const QString& outpDom, UnaryFunction fun);
+    UnaryMath(quint64 metaid, const Ilwis::OperationExpression &expr, const QString& outpDom, UnaryFunction fun, UnaryRunFunction runFun=UnaryRunFunction());
 
 protected:
     static Resource populateMetadata(const QString &item, const QString &longname, const QString& outputDom);
@@ -31,6 +43,7 @@ protected:
     double _number;
     QString _outputDomain;
     UnaryFunction _unaryFun;
+    UnaryRunFunction _unaryRunFun;
 
 };
 }
@@ -13,7 +13,7 @@ using namespace BaseOperations;
 
 REGISTER_OPERATION(Sine)
 
-Sine::Sine(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "min1to1", sin)
+Sine::Sine(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "min1to1", sin, unaryRun<sin>)
 {}
 OperationImplementation *Sine::create(quint64 metaid, const Ilwis::OperationExpression &expr){return new Sine(metaid,expr);}
 
@@ -27,7 +27,7 @@ quint64 Sine::createMetadata() {
 }
 //----------------------------------------------------------
 REGISTER_OPERATION(Cosine)
-Cosine::Cosine(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "min1to1", cos)
+Cosine::Cosine(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "min1to1", cos, unaryRun<cos>)
 {}
 OperationImplementation *Cosine::create(quint64 metaid, const Ilwis::OperationExpression &expr){return new Cosine(metaid,expr);}
 
@@ -48,7 +48,7 @@ double tangent(double v){
 }
 
 REGISTER_OPERATION(Tangent)
-Tangent::Tangent(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", tangent)
+Tangent::Tangent(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", tangent, unaryRun<tangent>)
 {}
 OperationImplementation *Tangent::create(quint64 metaid, const Ilwis::OperationExpression &expr){return new Tangent(metaid,expr);}
 
@@ -70,7 +70,7 @@ double arcsine(double v){
 
 REGISTER_OPERATION(Arcsine)
 
-Arcsine::Arcsine(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", arcsine)
+Arcsine::Arcsine(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", arcsine, unaryRun<arcsine>)
 {}
 OperationImplementation *Arcsine::create(quint64 metaid, const Ilwis::OperationExpression &expr){return new Arcsine(metaid,expr);}
 
@@ -91,7 +91,7 @@ double arccosine(double v){
 }
 
 REGISTER_OPERATION(Arccosine)
-Arccosine::Arccosine(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", arccosine)
+Arccosine::Arccosine(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", arccosine, unaryRun<arccosine>)
 {}
 OperationImplementation *Arccosine::create(quint64 metaid, const Ilwis::OperationExpression &expr){return new Arccosine(metaid,expr);}
 
@@ -106,7 +106,7 @@ quint64 Arccosine::createMetadata() {
 
 //----------------------------------------------------------
 REGISTER_OPERATION(ArcTangent)
-ArcTangent::ArcTangent(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", atan)
+ArcTangent::ArcTangent(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", atan, unaryRun<atan>)
 {}
 OperationImplementation *ArcTangent::create(quint64 metaid, const Ilwis::OperationExpression &expr){return new ArcTangent(metaid,expr);}
 
@@ -125,7 +125,7 @@ double logten(double v){
     return rUNDEF;
 }
 REGISTER_OPERATION(Log10)
-Log10::Log10(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", logten)
+Log10::Log10(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", logten, unaryRun<logten>)
 {}
 OperationImplementation *Log10::create(quint64 metaid, const Ilwis::OperationExpression &expr){return new Log10(metaid,expr);}
 
@@ -145,7 +145,7 @@ double naturallog(double v){
 }
 
 REGISTER_OPERATION(NaturalLogarithm)
-NaturalLogarithm::NaturalLogarithm(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", naturallog)
+NaturalLogarithm::NaturalLogarithm(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", naturallog, unaryRun<naturallog>)
 {}
 OperationImplementation *NaturalLogarithm::create(quint64 metaid, const Ilwis::OperationExpression &expr){return new NaturalLogarithm(metaid,expr);}
 
@@ -165,7 +165,7 @@ double abs2(double v){
     return v;
 }
 REGISTER_OPERATION(Abs)
-Abs::Abs(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", abs2)
+Abs::Abs(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", abs2, unaryRun<abs2>)
 {}
 OperationImplementation *Abs::create(quint64 metaid, const Ilwis::OperationExpression &expr){return new Abs(metaid,expr);}
 
@@ -186,7 +186,7 @@ double sqrt2(double v){
     return std::sqrt(v);
 }
 REGISTER_OPERATION(Sqrt)
-Sqrt::Sqrt(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", sqrt2)
+Sqrt::Sqrt(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", sqrt2, unaryRun<sqrt2>)
 {}
 OperationImplementation *Sqrt::create(quint64 metaid, const Ilwis::OperationExpression &expr){return new Sqrt(metaid,expr);}
 
@@ -236,7 +236,7 @@ double sign(double v) {
 }
 
 REGISTER_OPERATION(Sign)
-Sign::Sign(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "integer", sign)
+Sign::Sign(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "integer", sign, unaryRun<sign>)
 {}
 OperationImplementation *Sign::create(quint64 metaid, const Ilwis::OperationExpression &expr){return new Floor(metaid,expr);}
 
@@ -250,7 +250,7 @@ quint64 Sign::createMetadata() {
 }
 //----------------------------------------------------------
 REGISTER_OPERATION(CosineH)
-CosineH::CosineH(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", cosh)
+CosineH::CosineH(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", cosh, unaryRun<cosh>)
 {}
 OperationImplementation *CosineH::create(quint64 metaid, const Ilwis::OperationExpression &expr){return new CosineH(metaid,expr);}
 
@@ -264,7 +264,7 @@ quint64 CosineH::createMetadata() {
 }
 //----------------------------------------------------------
 REGISTER_OPERATION(SineH)
-SineH::SineH(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", sinh)
+SineH::SineH(quint64 metaid,const Ilwis::OperationExpression& expr) : UnaryMath(metaid, expr, "value", sinh, unaryRun<sinh>)
 {}
 OperationImplementation *SineH::create(quint64 metaid, const Ilwis::OperationExpression &expr){return new SineH(metaid,expr);}
 
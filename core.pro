@@ -48,6 +48,7 @@ SOURCES += core/kernel.cpp \
     core/ilwisobjects/coverage/featurecoverage.cpp \
     core/ilwisobjects/coverage/feature.cpp \
     core/ilwisobjects/coverage/grid.cpp \
+    core/ilwisobjects/coverage/gridblockcache.cpp \
     core/ilwisobjects/coverage/pixeliterator.cpp \
     core/ilwisobjects/table/flattable.cpp \
     core/ilwisobjects/table/columndefinition.cpp \
@@ -64,6 +65,7 @@ SOURCES += core/kernel.cpp \
     core/ilwisobjects/operation/operationExpression.cpp \
     core/ilwisobjects/operation/commandhandler.cpp \
     core/ilwisobjects/coverage/blockiterator.cpp \
+    core/ilwisobjects/coverage/bandvectoriterator.cpp \
     core/util/locker.cpp \
     core/ilwisobjects/domain/datadefinition.cpp \
     core/ilwisobjects/geometry/georeference/ctpgeoreference.cpp \
@@ -74,6 +76,7 @@ SOURCES += core/kernel.cpp \
     core/ilwisobjects/geometry/georeference/georefadapter.cpp \
     core/ilwisobjects/operation/symboltable.cpp \
     core/ilwisobjects/operation/operationhelpergrid.cpp \
+    core/ilwisobjects/operation/tilescheduler.cpp \
     core/ilwisobjects/operation/operationhelper.cpp \
     core/ilwisobjects/operation/operationhelperfeatures.cpp \
     core/ilwisobjects/geometry/georeference/georefimplementation.cpp \
@@ -119,6 +122,8 @@ SOURCES += core/kernel.cpp \
     core/util/supportlibraryloader.cpp \
     core/iooptions.cpp \
     core/ilwisobjects/table/record.cpp \
+    core/ilwisobjects/table/columnstore.cpp \
+    core/ilwisobjects/table/columnindex.cpp \
     core/ilwisobjects/table/attributedefinition.cpp \
     core/ilwisobjects/table/attributetable.cpp \
     core/ilwisobjects/table/selectabletable.cpp \
@@ -172,6 +177,7 @@ HEADERS += core/kernel.h\
     core/util/memorymanager.h \
     core/ilwisobjects/domain/itemrange.h \
     core/ilwisobjects/coverage/blockiterator.h \
+    core/ilwisobjects/coverage/bandvectoriterator.h \
     core/util/angle.h \
     core/util/box.h \
     core/ilwisobjects/coverage/pixeliterator.h \
@@ -179,6 +185,7 @@ HEADERS += core/kernel.h\
     core/ilwisobjects/coverage/featurecoverage.h \
     core/util/containerstatistics.h \
     core/ilwisobjects/coverage/grid.h \
+    core/ilwisobjects/coverage/gridblockcache.h \
     core/util/size.h \
     core/ilwisobjects/table/flattable.h \
     core/ilwisobjects/table/columndefinition.h \
@@ -210,6 +217,7 @@ HEADERS += core/kernel.h\
     core/ilwisobjects/geometry/georeference/georefadapter.h \
     core/ilwisobjects/operation/symboltable.h \
     core/ilwisobjects/operation/operationhelpergrid.h \
+    core/ilwisobjects/operation/tilescheduler.h \
     core/ilwisobjects/operation/operationhelper.h \
     core/ilwisobjects/operation/operationhelperfeatures.h \
     core/ilwisobjects/geometry/georeference/georefimplementation.h \
@@ -263,6 +271,8 @@ HEADERS += core/kernel.h\
     core/iooptions.h \
     core/ilwisobjects/operation/operationspec.h \
     core/ilwisobjects/table/record.h \
+    core/ilwisobjects/table/columnstore.h \
+    core/ilwisobjects/table/columnindex.h \
     core/ilwisobjects/table/attributedefinition.h \
     core/ilwisinterfaces.h \
     core/ilwisobjects/table/attributetable.h \
@@ -0,0 +1,89 @@
+#include "raster.h"
+#include "pixeliterator.h"
+#include "bandvectoriterator.h"
+
+using namespace Ilwis;
+
+namespace {
+const qint64 RUNPIXELS = 4096;
+}
+
+BandVectorIterator::BandVectorIterator(const IRasterCoverage &raster, const BoundingBox &box) : _box(box)
+{
+    if ( _box.isNull())
+        _box = BoundingBox(raster->size());
+    _box.ensure(raster->size());
+
+    qint32 zmin = isNumericalUndef(_box.min_corner().z) ? 0 : _box.min_corner().z;
+    qint32 zmax = isNumericalUndef(_box.max_corner().z) ? 0 : _box.max_corner().z;
+    _bands = zmax - zmin + 1;
+    for(qint32 z = zmin; z <= zmax; ++z) {
+        BoundingBox bandBox(Pixel(_box.min_corner().x, _box.min_corner().y, z), Pixel(_box.max_corner().x, _box.max_corner().y, z));
+        _bandIterators.push_back(PixelIterator(raster, bandBox));
+    }
+    _endIndex = (quint64)_box.xlength() * _box.ylength();
+    _buffer.resize(std::min((qint64)_endIndex, RUNPIXELS) * _bands);
+    fill();
+}
+
+BandVectorIterator::BandVectorIterator(quint64 endIndex) : _index(endIndex), _endIndex(endIndex)
+{
+}
+
+bool BandVectorIterator::operator==(const BandVectorIterator &iter) const
+{
+    return _index == iter._index;
+}
+
+bool BandVectorIterator::operator!=(const BandVectorIterator &iter) const
+{
+    return !operator==(iter);
+}
+
+BandVectorIterator BandVectorIterator::end() const
+{
+    return BandVectorIterator(_endIndex);
+}
+
+quint32 BandVectorIterator::bands() const
+{
+    return _bands;
+}
+
+Pixel BandVectorIterator::position() const
+{
+    quint32 xlength = _box.xlength();
+    return Pixel(_box.min_corner().x + _index % xlength, _box.min_corner().y + _index / xlength);
+}
+
+const BoundingBox &BandVectorIterator::box() const
+{
+    return _box;
+}
+
+void BandVectorIterator::fill()
+{
+    _bufferIndex = 0;
+    _bufferPixels = 0;
+    if ( _index >= _endIndex)
+        return;
+
+    std::vector<std::pair<double *, double *>> runs(_bands);
+    qint64 cells = std::min((qint64)(_endIndex - _index), RUNPIXELS);
+    for(quint32 band = 0; band < _bands; ++band) {
+        runs[band] = _bandIterators[band].span();
+        cells = std::min(cells, (qint64)(runs[band].second - runs[band].first));
+    }
+    if ( cells <= 0) { // a band ran out before the box did; nothing sensible is left to give
+        _index = _endIndex;
+        return;
+    }
+
+    for(quint32 band = 0; band < _bands; ++band) {
+        const double *run = runs[band].first;
+        for(qint64 i = 0; i < cells; ++i)
+            _buffer[i * _bands + band] = run[i];
+        _bandIterators[band] += cells;
+    }
+    _bufferPixels = cells;
+}
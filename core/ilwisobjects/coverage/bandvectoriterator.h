@@ -0,0 +1,63 @@
+#ifndef BANDVECTORITERATOR_H
+#define BANDVECTORITERATOR_H
+
+namespace Ilwis {
+
+/*!
+ * \brief The BandVectorIterator class iterates over the pixels of a multi band raster and gives per pixel the values of all bands
+ *
+ * The grid stores every band as its own sequence of blocks, so walking a z-column per pixel (the fZXY flow of the PixelIterator) touches
+ * a different block for every band of every pixel. This iterator reads a contiguous run of cells from all bands at once (see PixelIterator::span)
+ * and interleaves them in a buffer; every block is visited once per run instead of once per pixel. A run is at most a few thousand pixels,
+ * so the buffer stays small whatever the size of the blocks. end() is a bare sentinel that only carries the end position.
+ *
+ *    BandVectorIterator iter(multibandRaster);
+ *    BandVectorIterator iterEnd = iter.end();
+ *    while(iter != iterEnd) {
+ *        const double *values = *iter; // values[0] .. values[iter.bands() - 1]
+ *        ...
+ *        ++iter;
+ *    }
+ *
+ * The bands are the z range of the box; x and y flow as in the fXYZ flow.
+ */
+class KERNELSHARED_EXPORT BandVectorIterator
+{
+public:
+    BandVectorIterator(const IRasterCoverage& raster, const BoundingBox& box=BoundingBox());
+
+    const double *operator*() const {
+        return &_buffer[_bufferIndex * _bands];
+    }
+
+    BandVectorIterator& operator++() {
+        ++_index;
+        if ( ++_bufferIndex >= _bufferPixels)
+            fill();
+        return *this;
+    }
+
+    bool operator==(const BandVectorIterator& iter) const;
+    bool operator!=(const BandVectorIterator& iter) const;
+    BandVectorIterator end() const;
+
+    quint32 bands() const;
+    Pixel position() const;
+    const BoundingBox& box() const;
+
+private:
+    BandVectorIterator(quint64 endIndex);
+    void fill();
+
+    std::vector<PixelIterator> _bandIterators;
+    BoundingBox _box;
+    quint32 _bands = 0;
+    std::vector<double> _buffer;
+    quint64 _bufferPixels = 0;
+    quint64 _bufferIndex = 0;
+    quint64 _index = 0;
+    quint64 _endIndex = 0;
+};
+}
+
+#endif // BANDVECTORITERATOR_H
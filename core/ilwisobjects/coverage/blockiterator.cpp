@@ -132,6 +132,21 @@ double GridBlock::operator ()(qint32 x, qint32 y, qint32 z) const
 
 }
 
+std::pair<double *, double *> GridBlock::span(qint32 x, qint32 y, qint32 z)
+{
+    if ( !isValid())
+        throw ErrorObject(TR("Using invalid pixeliterator, are all data sources accessible?"));
+
+    x += _iterator._x;
+    y += _iterator._y;
+    z += _iterator._z;
+    if ( x < 0 || x > _iterator._endx || y < 0 || y > _iterator._endy || z < 0 || z > _iterator._endz)
+        return std::pair<double *, double *>(0, 0);
+
+    double *first = &_iterator._raster->_grid->value(_internalBlockNumber[y] + _bandOffset * z, _offsets[y] + x);
+    return std::pair<double *, double *>(first, first + _iterator._endx - x + 1);
+}
+
 void GridBlock::actualPosition(qint32& x, qint32& y, qint32& z) const
 {
     x = std::max(0, std::min(_iterator._x + x, _iterator._endx));
@@ -58,6 +58,15 @@ public:
 
     GridBlock(BlockIterator& biter);
     double& operator()(qint32 x, qint32 y, qint32 z=0);
+    /*!
+     * \brief span the cells of a row of the block that lie contiguous in memory, starting at (x,y,z) relative to the block
+     *
+     * The run ends at the right edge of the box. Unlike operator() nothing is clamped, so a start position outside the raster or beyond the box
+     * gives an empty run and the caller has to fall back to operator() for the border cells. The pointers are meant to be used
+     * straight away, before the iterator moves on.
+     * \return begin and end (one beyond the last cell) of the run
+     */
+    std::pair<double*, double*> span(qint32 x, qint32 y, qint32 z=0);
     double operator()(qint32 x, qint32 y, qint32 z=0) const;
     Size<> size() const;
     CellIterator begin() ;
@@ -8,6 +8,7 @@
 #include "featurefactory.h"
 #include "featurecoverage.h"
 #include "attributetable.h"
+#include "tablemerger.h"
 #include "feature.h"
 #include "featureiterator.h"
 #include "geos/geom/CoordinateFilter.h"
@@ -252,6 +253,21 @@ void FeatureCoverage::attributesFromTable(const ITable& otherTable)
     }
 }
 
+bool FeatureCoverage::attributesFromTable(const ITable &otherTable, const QString &featureKey, const QString &tableKey)
+{
+    TableMerger merger;
+    ITable joined = merger.join(attributeTable(), featureKey, otherTable, tableKey, TableMerger::jtLEFT);
+    if ( !joined.isValid())
+        return false;
+    // a left join gives at least one record per feature, more only if the key of otherTable is not unique
+    if ( joined->recordCount() != _features.size()) {
+        ERROR2(ERR_ILLEGAL_VALUE_2, TR("key column"), tableKey);
+        return false;
+    }
+    attributesFromTable(joined);
+    return true;
+}
+
 FeatureAttributeDefinition &FeatureCoverage::attributeDefinitionsRef(qint32 level)
 {
     if ( level <= 0)
@@ -163,6 +163,14 @@ public:
     void setFeatureCount(IlwisTypes types, qint32 featureCnt, quint32 level);
     ITable attributeTable(quint32 level=0) ;
     void attributesFromTable(const ITable &otherTable);
+    /*!
+     * \brief attributesFromTable joins a table to the features: every feature gets the record of otherTable of which tableKey has the value of featureKey
+     *
+     * The attributes of the features stay, the columns of otherTable are added; features without a match get undefined values.
+     * The join is a hash join (see TableMerger::join), so the keys are not compared record by record.
+     * \return false if the keys can not be compared or a feature matches more than one record
+     */
+    bool attributesFromTable(const ITable &otherTable, const QString& featureKey, const QString& tableKey);
     FeatureAttributeDefinition& attributeDefinitionsRef(qint32 level=0) ;
     const FeatureAttributeDefinition& attributeDefinitions(qint32 level=0) const;
 
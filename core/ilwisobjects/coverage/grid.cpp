@@ -1,8 +1,12 @@
+#include <thread>
+#include <condition_variable>
+#include <deque>
 #include "raster.h"
 #include "ilwiscontext.h"
 #include "connectorinterface.h"
 #include "geometries.h"
 #include "grid.h"
+#include "gridblockcache.h"
 
 using namespace Ilwis;
 GridBlockInternal::GridBlockInternal(quint32 blocknr, quint64 rasterid,quint32 lines , quint32 width) :  _size(Size<>(width, lines,1)),_id(blocknr),_rasterid(rasterid), _initialized(false), _inMemory(false)
@@ -12,41 +16,24 @@ GridBlockInternal::GridBlockInternal(quint32 blocknr, quint64 rasterid,quint32 l
 }
 
 GridBlockInternal::~GridBlockInternal() {
-
+    if ( _mappedFile && _cells)
+        _mappedFile->unmap(_cells);
 }
 
 Size<> GridBlockInternal::size() const {
     return _size;
 }
 
-GridBlockInternal *GridBlockInternal::clone()
-{
-    GridBlockInternal *block = new GridBlockInternal(_id, i64UNDEF, _size.xsize(), _size.ysize());
-    block->prepare();
-    block->_undef = _undef;
-    block->_blockSize = _blockSize;
-    if(!inMemory())
-        loadFromCache();
-    else if (!_initialized){
-        needData();
-    }
-    std::copy(_data.begin(), _data.end(), block->_data.begin());
-
-    return block;
-
-
-}
-
 char *GridBlockInternal::blockAsMemory() {
     prepare();
-    return (char *)&_data[0];
+    return (char *)_cells;
 }
 
 void GridBlockInternal::fill(const std::vector<double>& values) {
 
-    if ( values.size() != _data.size())
+    if ( !_initialized)
         prepare(values.size() == 0);
-    copy(values.begin(), values.end(), _data.begin());
+    std::copy(values.begin(), values.begin() + std::min((quint64)values.size(), _blockSize), _cells);
 
 }
 
@@ -54,7 +41,133 @@ quint32 GridBlockInternal::blockSize() {
     return _blockSize;
 }
 
-inline bool GridBlockInternal::save2Cache() {
+namespace {
+template<typename T> void packValues(const std::vector<double>& data, std::vector<char>& packed, bool hasUndef) {
+    packed.resize(data.size() * sizeof(T));
+    T *cells = (T *)&packed[0];
+    T undefValue = undef<T>();
+    for(quint64 i = 0; i < data.size(); ++i) {
+        double v = data[i];
+        cells[i] = (hasUndef && v == rUNDEF) ? undefValue : (T)v;
+    }
+}
+
+template<typename T> void unpackValues(const std::vector<char>& packed, std::vector<double>& data, bool hasUndef) {
+    const T *cells = (const T *)&packed[0];
+    T undefValue = undef<T>();
+    for(quint64 i = 0; i < data.size(); ++i) {
+        T v = cells[i];
+        data[i] = (hasUndef && v == undefValue) ? rUNDEF : (double)v;
+    }
+}
+}
+
+IlwisTypes GridBlockInternal::packType(IlwisTypes hint) const
+{
+    if ( hint == itDOUBLE) // the data definition already tells that nothing smaller will do
+        return itDOUBLE;
+
+    bool integral = true, exactFloat = true, hasUndef = false;
+    bool clashShort = false, clashInt = false;
+    double vmin = std::numeric_limits<double>::max(), vmax = -std::numeric_limits<double>::max();
+    for(double v : _data) {
+        if ( v == rUNDEF) {
+            hasUndef = true;
+            continue;
+        }
+        if ( integral && v != std::floor(v))
+            integral = false;
+        if ( exactFloat && ((double)(float)v != v || v == flUNDEF))
+            exactFloat = false;
+        if ( !integral && !exactFloat)
+            return itDOUBLE;
+        clashShort |= v == shUNDEF;
+        clashInt |= v == iUNDEF;
+        vmin = std::min(vmin, v);
+        vmax = std::max(vmax, v);
+    }
+    if ( integral) {
+        // uint8 has no room for an undefined marker (its undef is 0) so it can only hold blocks without undefineds
+        if ( !hasUndef && vmin >= 0 && vmax <= 255)
+            return itUINT8;
+        if ( !clashShort && vmin >= std::numeric_limits<qint16>::min() && vmax <= std::numeric_limits<qint16>::max())
+            return itINT16;
+        if ( !clashInt && vmin >= std::numeric_limits<qint32>::min() && vmax <= std::numeric_limits<qint32>::max())
+            return itINT32;
+    }
+    if ( exactFloat)
+        return itFLOAT;
+
+    return itDOUBLE;
+}
+
+bool GridBlockInternal::pack(IlwisTypes hint)
+{
+    if ( _mappedFile) // mapped blocks are swapped as they are
+        return false;
+    if ( !_initialized)
+        return isPacked();
+
+    _packedType = packType(hint);
+    switch(_packedType){
+    case itUINT8:
+        packValues<quint8>(_data, _packed, false); break;
+    case itINT16:
+        packValues<qint16>(_data, _packed, true); break;
+    case itINT32:
+        packValues<qint32>(_data, _packed, true); break;
+    case itFLOAT:
+        packValues<float>(_data, _packed, true); break;
+    default:
+        _packedType = itDOUBLE;
+        packValues<double>(_data, _packed, false); break;
+    }
+    _initialized = false;
+    _inMemory = false;
+    _cells = 0;
+    std::vector<double>().swap(_data);
+
+    return true;
+}
+
+void GridBlockInternal::unpack()
+{
+    switch(_packedType){
+    case itUINT8:
+        unpackValues<quint8>(_packed, _data, false); break;
+    case itINT16:
+        unpackValues<qint16>(_packed, _data, true); break;
+    case itINT32:
+        unpackValues<qint32>(_packed, _data, true); break;
+    case itFLOAT:
+        unpackValues<float>(_packed, _data, true); break;
+    default:
+        unpackValues<double>(_packed, _data, false); break;
+    }
+    std::vector<char>().swap(_packed);
+}
+
+void GridBlockInternal::unmap()
+{
+    if ( _cells)
+        _mappedFile->unmap(_cells); // dirty pages are written back by the system
+    _cells = 0;
+    _initialized = false;
+    _inMemory = false;
+}
+
+inline bool GridBlockInternal::save2Cache(IlwisTypes hint) {
+    if ( _mappedFile) {
+        unmap();
+        return true;
+    }
+    if ( !isPacked()) {
+        if ( !_initialized) { // nothing resident; the block was never loaded or is already in the swap file
+            _inMemory = false;
+            return true;
+        }
+        pack(hint);
+    }
     _inMemory = false;
     if ( _tempName == sUNDEF) {
         QString name = QString("gridblock_%1").arg(_id);
@@ -71,36 +184,50 @@ inline bool GridBlockInternal::save2Cache() {
     if(!_swapFile->open() ){
         return ERROR1(ERR_COULD_NOT_OPEN_WRITING_1,_tempName);
     }
-    quint64 bytesNeeded = _data.size() * sizeof(double);
-    quint64 total =_swapFile->write((char *)&_data[0], bytesNeeded);
+    // the swap file holds the cells in their packed type, so a byte raster costs a byte per cell of I/O
+    quint64 bytesNeeded = _packed.size();
+    _swapFile->seek(0);
+    quint64 total =_swapFile->write(&_packed[0], bytesNeeded);
     _swapFile->close();
     if ( total != bytesNeeded) {
         return ERROR1(ERR_COULD_NOT_OPEN_WRITING_1,_tempName);
     }
-    _initialized = false;
-    _data = std::vector<double>();
+    _swappedSize = bytesNeeded;
+    std::vector<char>().swap(_packed);
 
     return true;
 
 }
 
 bool GridBlockInternal::loadFromCache() {
-     _inMemory = true;
-    prepare();
-    if ( _tempName == sUNDEF) {
-        return true; // totaly new block; never been swapped so no load needed
+    _inMemory = true;
+    if ( _mappedFile) {
+        prepare();
+        return _cells != 0;
     }
-    quint64 bytesNeeded = _data.size() * sizeof(double);
-    if(!_swapFile->open() ){
-        return ERROR1(ERR_COULD_NOT_OPEN_READING_1,_tempName);
+    if ( _initialized) // resident already, nothing to load
+        return true;
+    if ( !isPacked() && _swappedSize > 0) {
+        std::vector<char> buffer(_swappedSize);
+        if(!_swapFile->open() ){
+            _inMemory = false;
+            return ERROR1(ERR_COULD_NOT_OPEN_READING_1,_tempName);
+        }
+        _swapFile->seek(0);
+        quint64 total =_swapFile->read(&buffer[0], _swappedSize);
+        _swapFile->close();
+        if ( total != _swappedSize) {
+            _inMemory = false;
+            return ERROR1(ERR_COULD_NOT_OPEN_READING_1,_tempName);
+        }
+        _packed.swap(buffer);
     }
-    quint64 total =_swapFile->read((char *)&_data[0], bytesNeeded);
-
-    _swapFile->close();
-    if ( total != bytesNeeded) {
-        _inMemory = false;
-        return ERROR1(ERR_COULD_NOT_OPEN_READING_1,_tempName);
+    if ( _preparing) { // called from prepare(), the data vector is already there
+        if ( isPacked())
+            unpack();
+        return true;
     }
+    prepare(); // unpacks the cells or, for a totaly new block, fetches them
     return true;
 
 }
@@ -116,7 +243,103 @@ void GridBlockInternal::needData()
 
 
 //----------------------------------------------------------------------
-Grid::Grid(int maxlines) : _inMemoryIndex(iUNDEF), _memUsed(0),_blocksPerBand(0), _maxLines(maxlines){
+GridMappedFile::GridMappedFile(quint64 blockBytes) : _blockBytes(blockBytes)
+{
+    QDir localDir(context()->cacheLocation().toLocalFile());
+    if ( !localDir.exists()) {
+        localDir.mkpath(localDir.absolutePath());
+    }
+    _file.setFileTemplate(localDir.absolutePath() + "/gridmap_XXXXXX");
+}
+
+bool GridMappedFile::prepare(quint32 blocks)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if ( !_file.isOpen() && !_file.open()) {
+        return ERROR1(ERR_COULD_NOT_OPEN_WRITING_1,_file.fileTemplate());
+    }
+    // only the length is set; blocks that are never swapped take no disk space on file systems with sparse files
+    return _file.resize(blocks * _blockBytes);
+}
+
+double *GridMappedFile::map(quint32 block, quint64 cells)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return (double *)_file.map(block * _blockBytes, cells * sizeof(double));
+}
+
+void GridMappedFile::unmap(double *cells)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _file.unmap((uchar *)cells);
+}
+
+//----------------------------------------------------------------------
+namespace {
+/*
+ * background thread that loads grid blocks ahead of sequential scans, so that decoding by the connector
+ * overlaps with the computation on the current block
+ */
+class GridPrefetcher {
+public:
+    GridPrefetcher() {
+        std::thread worker([this]{ run(); });
+        worker.detach();
+    }
+
+    void request(Grid *grid, quint32 block) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for(const auto& job : _jobs) {
+            if ( job.first == grid && job.second == block)
+                return;
+        }
+        _jobs.push_back({grid, block});
+        _wakeup.notify_one();
+    }
+
+    // removes the pending requests of a grid and waits for the one that is running; the grid is going away
+    void cancel(Grid *grid) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _jobs.erase(std::remove_if(_jobs.begin(), _jobs.end(),[grid](const std::pair<Grid *, quint32>& job){ return job.first == grid;}), _jobs.end());
+        _done.wait(lock, [this, grid]{ return _busy != grid;});
+    }
+
+private:
+    void run() {
+        while(true) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wakeup.wait(lock, [this]{ return _jobs.size() > 0;});
+            auto job = _jobs.front();
+            _jobs.pop_front();
+            _busy = job.first;
+            lock.unlock();
+            try {
+                job.first->preload(job.second);
+            } catch(const ErrorObject&){
+                // a failing read ahead is not an error; the iterator will run into it (and report it) itself
+            } catch(const std::exception&){
+            }
+            lock.lock();
+            _busy = 0;
+            _done.notify_all();
+        }
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _wakeup;
+    std::condition_variable _done;
+    std::deque<std::pair<Grid *, quint32>> _jobs;
+    Grid *_busy = 0;
+};
+
+GridPrefetcher *prefetcher() {
+    static GridPrefetcher *prefetcher = new GridPrefetcher(); // never deleted, the thread lives as long as the process
+    return prefetcher;
+}
+}
+
+//----------------------------------------------------------------------
+Grid::Grid(int maxlines) : _memUsed(0),_blocksPerBand(0), _maxLines(maxlines){
     //Locker lock(_mutex);
 
     if ( _maxLines == iUNDEF){
@@ -125,6 +348,7 @@ Grid::Grid(int maxlines) : _inMemoryIndex(iUNDEF), _memUsed(0),_blocksPerBand(0)
              _maxLines = 1e8 / (size().xsize() * 8);
          }
     }
+    _prefetchDepth = context()->configurationRef()("system-settings/grid-prefetch",2);
 }
 
 quint32 Grid::blockSize(quint32 index) const {
@@ -135,7 +359,6 @@ quint32 Grid::blockSize(quint32 index) const {
 
 Grid::~Grid() {
     clear();
-    context()->changeMemoryLeft(_memUsed);
 }
 
 Size<> Grid::size() const {
@@ -157,32 +380,55 @@ Grid *Grid::clone(quint32 index1, quint32 index2)
     quint32 end = index2 == iUNDEF ? _blocks.size() / _blocksPerBand : index2 + 1;
 
     Grid *grid = new Grid(_maxLines);
-    grid->prepare(0,Size<>(_size.xsize(), _size.ysize(), end - start));
+    grid->_storeType = _storeType; // prepare() has no raster to take it from
+    if (!grid->prepare(0,Size<>(_size.xsize(), _size.ysize(), end - start))) {
+        delete grid;
+        return 0;
+    }
 
+    // the blocks of both grids are loaded the regular way, so the cache accounts for them and the copy can swap its blocks
+    Locker<> lock(_mutex);
+    Locker<> cloneLock(grid->_mutex);
     quint32 startBlock = start * _blocksPerBand;
     quint32 endBlock = std::min(end * _blocksPerBand, (quint32)_blocks.size());
-    for(int i=startBlock, j=0; i < endBlock; ++i, ++j) {
-        grid->_blocks[j] = _blocks[i]->clone();
+    for(quint32 i=startBlock, j=0; i < endBlock && j < grid->_blocks.size(); ++i, ++j) {
+        GridBlockInternal *source = _blocks[i];
+        GridBlockInternal *target = grid->_blocks[j];
+        if ( _allInMemory)
+            source->preload();
+        else if (!update(i))
+            continue;
+        source->pin(); // loading the target block may make room by evicting blocks of this grid
+        if ( grid->_allInMemory || grid->update(j, true)) {
+            double *cells = (double *)target->blockAsMemory();
+            quint32 count = std::min(source->blockSize(), target->blockSize());
+            std::copy(&source->at(0), &source->at(0) + count, cells);
+        }
+        source->unpin();
     }
-    grid->_inMemoryIndex = 1;
-    grid->_memUsed = _memUsed;
     return grid;
 
 }
 
 void Grid::clear() {
+    prefetcher()->cancel(this);
+    gridBlockCache()->remove(this);
+    gridBlockCache()->release(_memUsed);
+    _memUsed = 0;
     _size = Size<>();
     _blockSizes = std::vector<quint32>();
     for(quint32 i = 0; i < _blocks.size(); ++i) {
         delete _blocks[i];
     }
     _blocks = std::vector< GridBlockInternal *>();
-    _cache = QList<quint32>();
+    _mappedFile.reset(0);
     _blockSizes =  std::vector<quint32>();
     _offsets = std::vector<std::vector<quint32>>();
     _blockOffsets = std::vector<quint32>();
-    _inMemoryIndex = iUNDEF;
     _allInMemory = false;
+    _narrowResident = false;
+    _wideBlocks.clear();
+    _isWide = std::vector<bool>();
     _size = Size<>();
 
 }
@@ -205,9 +451,8 @@ inline double &Grid::value(quint32 block, int offset )  {
         return _blocks[block]->at(offset);
 
     Locker<> lock(_mutex); // slower case. must prevent other threads to messup admin
-    if ( !_blocks[block]->inMemory())
-      if(!update(block))
-          throw ErrorObject(TR("Grid block is out of bounds"));
+    if(!update(block))
+        throw ErrorObject(TR("Grid block is out of bounds"));
 
     return _blocks[block]->at(offset); // block is now in memory
 }
@@ -221,13 +466,57 @@ inline void Grid::setValue(quint32 block, int offset, double v ) {
     }
 
     Locker<> lock(_mutex);
-    if ( !_blocks[block]->inMemory())
-        if(!update(block))
-            return ;
+    if(!update(block))
+        return ;
 
     _blocks[block]->at(offset) = v;
 }
 
+bool Grid::pin(quint32 block)
+{
+    if ( block >= _blocks.size())
+        return false;
+    if ( _allInMemory) // nothing will ever be evicted, no need to count
+        return true;
+
+    Locker<> lock(_mutex);
+    if(!update(block))
+        return false;
+    _blocks[block]->pin();
+    return true;
+}
+
+void Grid::unpin(quint32 block)
+{
+    if ( _allInMemory || block >= _blocks.size())
+        return;
+    _blocks[block]->unpin();
+}
+
+void Grid::prefetch(quint32 block)
+{
+    quint32 last = std::min((quint32)_blocks.size(), block + _prefetchDepth);
+    for(quint32 b = block; b < last; ++b) {
+        GridBlockInternal *du = _blocks[b];
+        if ( _allInMemory ? !du->isInitialized() : !du->inMemory())
+            prefetcher()->request(this, b);
+    }
+}
+
+void Grid::preload(quint32 block)
+{
+    if ( block >= _blocks.size())
+        return;
+    if ( _allInMemory) { // only the block itself is involved, the grid stays available for other threads
+        _blocks[block]->preload();
+        return;
+    }
+    // a busy grid is left alone; read ahead is an optimization, waiting for the lock could stall the grid being cleared
+    std::unique_lock<std::recursive_mutex> lock(_mutex, std::try_to_lock);
+    if ( lock.owns_lock())
+        update(block);
+}
+
 quint32 Grid::blocks() const {
     return _blocks.size();
 }
@@ -241,10 +530,10 @@ void Grid::setBlockData(quint32 block, const std::vector<double>& data, bool cre
         _blocks[block]->fill(data);
         return ;
     }
+    Locker<> lock(_mutex);
     if(!update(block, creation))
         return ;
-    //block will be at front now
-    _blocks[_cache[0]]->fill(data);
+    _blocks[block]->fill(data);
 }
 
 char *Grid::blockAsMemory(quint32 block, bool creation) {
@@ -256,7 +545,7 @@ char *Grid::blockAsMemory(quint32 block, bool creation) {
     Locker<> lock(_mutex);
     if(!update(block, creation))
         return 0;
-    GridBlockInternal *du = _blocks[_cache[block]];
+    GridBlockInternal *du = _blocks[block];
     char * p = du->blockAsMemory();
     return p;
 
@@ -270,17 +559,28 @@ void Grid::setBandProperties(RasterCoverage *raster, int n){
     _blocks.resize(newBlocks);
     _blockSizes.resize(newBlocks);
     _blockOffsets.resize(newBlocks);
+    _isWide.resize(newBlocks, false);
+    _wideLimit += n;
     qint32 totalLines = _size.ysize();
 
+    if ( _mappedFile)
+        _mappedFile->prepare(newBlocks);
+
     for(quint32 block = oldBlocks; block < _blocks.size(); ++block) {
         int linesPerBlock = std::min((qint32)_maxLines, totalLines);
         _blocks[block] = new GridBlockInternal(block,raster ? raster->id() : i64UNDEF,linesPerBlock, _size.xsize());
+        _blocks[block]->mappedFile(_mappedFile.get());
         _blockSizes[block] = linesPerBlock * _size.xsize();
         _blockOffsets[block] = block == 0 ? 0 : _blockOffsets[block-1] +  _blockSizes[block];
         totalLines -= _maxLines;
         if ( totalLines <= 0) // to next band
             totalLines = _size.ysize();
     }
+    if ( _allInMemory) { // the new bands are resident as well
+        quint64 extra = (quint64)n * _size.xsize() * _size.ysize() * sizeof(double);
+        gridBlockCache()->reserve(extra, true);
+        _memUsed += extra;
+    }
 }
 
 bool Grid::prepare(RasterCoverage *raster, const Size<> &sz) {
@@ -300,12 +600,22 @@ bool Grid::prepare(RasterCoverage *raster, const Size<> &sz) {
         _maxLines = 1e8 / (sz.xsize() * 8);
     }
 
+    if ( raster) { // without a raster (e.g. a clone) the store type is set by the owner
+        _storeType = itUNKNOWN;
+        if ( !raster->datadef().range().isNull())
+            _storeType = raster->datadef().range()->valueType();
+    }
+
+    // a grid that can have all its blocks resident reserves that memory in the shared cache and never swaps (nor locks);
+    // others have their blocks admitted and evicted one by one by the cache
     quint64 bytesNeeded = _size.linearSize() * sizeof(double);
-    quint64 mleft = context()->memoryLeft();
-    _memUsed = std::min(bytesNeeded, mleft/2);
-    context()->changeMemoryLeft(-_memUsed);
+    _allInMemory = gridBlockCache()->reserve(bytesNeeded);
+    _memUsed = _allInMemory ? bytesNeeded : 0;
+
+    // a raster with a narrow value type that does not fit keeps its blocks packed in that type and only a working set of them as doubles
+    _narrowResident = !_allInMemory && _storeType != itUNKNOWN && !hasType(_storeType, itDOUBLE);
+    _wideLimit = 2 * std::max(1u, std::thread::hardware_concurrency()) + _size.zsize();
     int n = numberOfBlocks();
-    _inMemoryIndex = std::max(1ULL, n * _memUsed / bytesNeeded);
     _blocksPerBand = n / sz.zsize();
 
 
@@ -314,11 +624,19 @@ bool Grid::prepare(RasterCoverage *raster, const Size<> &sz) {
     _blocks.resize(nblocks);
     _blockSizes.resize(nblocks);
     _blockOffsets.resize(nblocks);
-    _allInMemory = _blocks.size() <= _inMemoryIndex;
+    _isWide.assign(nblocks, false);
+
+    // mapped blocks are swapped as doubles, packed blocks are smaller; so narrow grids keep the swap files
+    if ( !_allInMemory && !_narrowResident && ilwisconfig("system-settings/grid-swap",QString("files")) == "mapped") {
+        _mappedFile.reset(new GridMappedFile((quint64)_maxLines * _size.xsize() * sizeof(double)));
+        if ( !_mappedFile->prepare(nblocks))
+            _mappedFile.reset(0); // fall back on swap files
+    }
 
     for(quint32 i = 0; i < _blocks.size(); ++i) {
         int linesPerBlock = std::min((qint32)_maxLines, totalLines);
         _blocks[i] = new GridBlockInternal(i, raster ? raster->id() : i64UNDEF,linesPerBlock, _size.xsize());
+        _blocks[i]->mappedFile(_mappedFile.get());
         _blockSizes[i] = linesPerBlock * _size.xsize();
         _blockOffsets[i] = i == 0 ? 0 : _blockOffsets[i-1] +  _blockSizes[i];
         totalLines -= _maxLines;
@@ -346,53 +664,73 @@ int Grid::numberOfBlocks() {
     return nblocks * _size.zsize();
 }
 
-inline bool Grid::update(quint32 block, bool creation) {
+inline bool Grid::update(quint32 block, bool) {
     if ( block >= _blocks.size() ) // illegal, blocknumber is outside the allowed range
         return false;
-    if ( !_blocks[block]->inMemory()) { // if not loaded, load it from the temporary storage
-        try{
-        if(!_blocks[block]->loadFromCache()){
+    GridBlockInternal *du = _blocks[block];
+    if ( du->inMemory()) {
+        gridBlockCache()->touch(du);
+        return true;
+    }
+    try{ // not loaded, unpack it or load it from the temporary storage
+        if(!du->loadFromCache()){
             return false;
         }
-        } catch (const OutOfMemoryError& err){ // probably exceeded memory cappacity, unload the blocks and try again.
-            unload(false);
-            if(!_blocks[block]->loadFromCache()){
-                return false;
-            }
-
+    } catch (const OutOfMemoryError& err){ // probably exceeded memory cappacity, unload the blocks and try again.
+        unload(false);
+        if(!du->loadFromCache()){
+            return false;
         }
     }
-    if ( creation || _cache.size() == 0) { // at create time we want to preserver the original order in memory
+    gridBlockCache()->admit(this, block, du, du->blockSize() * sizeof(double));
+    if ( _narrowResident && !_isWide[block]) {
+        _isWide[block] = true;
+        _wideBlocks.push_back(block);
+        narrowBlocks(block);
+    }
+
+    return true;
+}
 
-        if ( _cache.size() > 0 &&  block > _inMemoryIndex ){
-            _blocks[_cache.back()]->save2Cache();
-            _cache.removeLast();
+void Grid::narrowBlocks(quint32 keep)
+{
+    // the oldest wide blocks are packed first; a pinned block is in use by an iterator and stays wide until a later round,
+    // as does the block that is being loaded (it is pinned only after this)
+    auto iter = _wideBlocks.begin();
+    while ( _wideBlocks.size() > _wideLimit && iter != _wideBlocks.end()) {
+        GridBlockInternal *du = _blocks[*iter];
+        if ( *iter == keep || du->isPinned()) {
+            ++iter;
+            continue;
         }
-        _cache.push_front(block);
+        if ( du->inMemory() && du->pack(_storeType)) // blocks the cache evicted meanwhile are packed or swapped already
+            gridBlockCache()->resize(du, du->packedSize());
+        _isWide[*iter] = false;
+        iter = _wideBlocks.erase(iter);
     }
-    else if ( _cache.front() != block) {
-        int index = _cache.indexOf(block);
-        if (index >=0) { //  find the block and move it to the front of the list; blocks that are in use are at the front to prevent them being unloaded
-            _cache.removeOne(index);
-        }
-        _cache.push_front(block); // block has now priority; if the block was not already in the list, the list will grow
-        if ( index > (int)_inMemoryIndex) { // the index is bigger than allowed, so the last element of the list is unloaded
-            if (_blocks[_cache.back()]->save2Cache()){
-                _cache.removeLast();
-                return true;
-            }
-        }
+}
 
+quint64 Grid::evict(quint32 block)
+{
+    GridBlockInternal *du = _blocks[block];
+    if ( du->isPinned()) // an iterator holds references into the cells, the block stays as it is
+        return du->inMemory() ? du->blockSize() * sizeof(double) : du->packedSize();
+    if ( du->inMemory()) { // first stage, keep the block packed in its native cell type in memory
+        if ( du->pack(_storeType) && du->packedType() != itDOUBLE)
+            return du->packedSize();
     }
-    return true;
+    // second stage (or packing gains nothing), the block goes to the swap file
+    if (!du->save2Cache(_storeType))
+        return du->packedSize();
+    return 0;
 }
 
 void Grid::unloadInternal(){
-    _cache.clear();
+    gridBlockCache()->remove(this, true);
     for(GridBlockInternal *block : _blocks) {
-        block->save2Cache();
+        if ( !block->isPinned())
+            block->save2Cache(_storeType);
     }
-    _inMemoryIndex = 0;
 }
 
 void Grid::unload(bool uselock) {
@@ -431,7 +769,7 @@ std::map<quint32, std::vector<quint32> > Grid::calcBlockLimits(const IOOptions&
 
 bool Grid::isValid() const
 {
-    return !(_size.isNull() || _size.isValid() || _inMemoryIndex == iUNDEF);
+    return !(_size.isNull() || _size.isValid() || _blocks.size() == 0);
 }
 
 
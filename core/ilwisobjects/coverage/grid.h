@@ -2,7 +2,9 @@
 #define Grid_H
 
 #include <list>
+#include <deque>
 #include <mutex>
+#include <atomic>
 #include <QDir>
 #include <QTemporaryFile>
 #include <iostream>
@@ -15,20 +17,49 @@ namespace Ilwis {
 
 class RasterCoverage;
 struct IOOptions;
+class GridBlockCache;
+
+/*!
+ * \brief The GridMappedFile class is the memory mapped swap backend of a grid
+ *
+ * One sparse file per grid with every block at a fixed offset. Blocks map their slot when they become resident and
+ * unmap it when evicted; the operating system writes dirty pages back and faults them in again when needed, so there is
+ * no allocation or copy involved in swapping.
+ */
+class GridMappedFile {
+public:
+    GridMappedFile(quint64 blockBytes);
+
+    bool prepare(quint32 blocks);
+    double *map(quint32 block, quint64 cells);
+    void unmap(double *cells);
+
+private:
+    std::mutex _mutex;
+    QTemporaryFile _file;
+    quint64 _blockBytes;
+};
 
+/*!
+ * \brief The GridBlockInternal class holds the cells of one block of a grid
+ *
+ * A block is either wide, its cells as doubles that the iterators use directly, or packed, its cells in the narrowest type that holds
+ * them losslessly (see pack()). A packed block is unpacked when it is used again; the grid decides how many blocks may be wide at the same time.
+ */
 class GridBlockInternal {
 public:
+    friend class GridBlockCache;
+
     GridBlockInternal(quint32 blocknr, quint64 rasterid, quint32 lines , quint32 width);
     ~GridBlockInternal();
 
 
     Size<> size() const ;
-    GridBlockInternal *clone();
 
     double& at(quint32 index) {
         prepare();
         if ( index < _blockSize){
-            return _data[index];
+            return _cells[index];
         }
         //throw ErrorObject(TR("Grid index out of bounds"));
         if (_undef != rUNDEF)
@@ -42,40 +73,83 @@ public:
 
     quint32 blockSize();
     bool inMemory() const { return _inMemory; }
-    inline bool save2Cache() ;
+    bool isPacked() const { return _packed.size() > 0; }
+    quint64 packedSize() const { return _packed.size(); }
+    IlwisTypes packedType() const { return _packedType; }
+    bool pack(IlwisTypes hint=itUNKNOWN);
+    void pin() { ++_pins; }
+    void unpin() { --_pins; }
+    bool isPinned() const { return _pins > 0; }
+    inline bool save2Cache(IlwisTypes hint=itUNKNOWN) ;
     bool loadFromCache();
+    void mappedFile(GridMappedFile *file) { _mappedFile = file; }
+    bool isInitialized() const { return _initialized; }
+    void preload() { prepare(); }
 
 private:
     void prepare(bool fetchData = true) {
         if (!_initialized) {
             Locker<> lock(_mutex);
-            if ( _initialized) // may happen due to multithreading
+            // may happen due to multithreading (another thread, e.g. the prefetcher, filled it while we waited for the lock)
+            // or because the connector fills this block from within needData()
+            if ( _initialized || _preparing)
                 return;
+            _preparing = true;
             try{
-            _data.resize(blockSize());
-            std::fill(_data.begin(), _data.end(), _undef);
-            _initialized = true;
-            if (!inMemory() && _tempName != sUNDEF)
-                loadFromCache();
-            else if ( fetchData)
-                needData();
-
+            if ( _mappedFile) { // the cells live in the swap file, pages are faulted in when touched
+                _cells = _mappedFile->map(_id, blockSize());
+                if ( !_cells)
+                    throw OutOfMemoryError( TR("Couldnt map grid block")) ;
+                if ( _swappedSize == 0) { // first use of this block
+                    _swappedSize = blockSize() * sizeof(double);
+                    std::fill(_cells, _cells + blockSize(), _undef);
+                    if ( fetchData)
+                        needData();
+                }
+            } else {
+                _data.resize(blockSize());
+                _cells = &_data[0];
+                std::fill(_data.begin(), _data.end(), _undef);
+                if (!inMemory() && (isPacked() || _swappedSize > 0))
+                    loadFromCache();
+                else if ( isPacked())
+                    unpack();
+                else if ( fetchData)
+                    needData();
+            }
             } catch(const std::bad_alloc& err){
+                _preparing = false;
                 throw OutOfMemoryError( TR("Couldnt allocate memory for raster")) ;
+            } catch(const ErrorObject& err){
+                _preparing = false;
+                throw;
             }
-
-
+            _preparing = false;
+            _initialized = true; // only now other threads may use the cells without locking
         }
     }
 
     void needData();
+    IlwisTypes packType(IlwisTypes hint) const;
+    void unpack();
+    void unmap();
+
     std::recursive_mutex _mutex;
     std::vector<double> _data;
+    double *_cells = 0; // either the data vector or the mapped slot in the swap file
+    GridMappedFile *_mappedFile = 0;
+    std::vector<char> _packed; // block in its native cell type while it is not resident
+    IlwisTypes _packedType = itUNKNOWN;
+    quint64 _swappedSize = 0;
+    std::atomic<qint32> _pins{0}; // pinned blocks are never evicted
+    std::atomic<bool> _referenced{false}; // reference bit for the clock of the block cache
+    qint32 _cacheSlot = -1; // administered by the block cache
     double _undef;
     Size<> _size;
     quint64 _id;
     quint64 _rasterid;
-    bool _initialized;
+    std::atomic<bool> _initialized;
+    bool _preparing = false;
     bool _inMemory;
     QString _tempName = sUNDEF;
     QScopedPointer<QTemporaryFile> _swapFile;
@@ -87,6 +161,7 @@ class KERNELSHARED_EXPORT Grid
 {
 public:
     friend class GridInterpolator;
+    friend class GridBlockCache;
 
     Grid(int maxLines=iUNDEF);
     virtual ~Grid();
@@ -97,6 +172,18 @@ public:
     double& value(quint32 block, int offset );
     double value(const Pixel& pix) ;
     void setValue(quint32 block, int offset, double v );
+    /*!
+     * \brief pinnedValue direct access to a cell of a block pinned by the caller
+     *
+     * No locking and no residency checks; the caller must hold a pin on the block (see pin()) for as long as it uses the reference
+     */
+    double& pinnedValue(quint32 block, int offset ) {
+        return _blocks[block]->at(offset);
+    }
+    bool pin(quint32 block);
+    void unpin(quint32 block);
+    void prefetch(quint32 block);
+    void preload(quint32 block);
 
     quint32 blocks() const;
     quint32 blocksPerBand() const;
@@ -119,14 +206,15 @@ private:
     double bicubic(const Pixeld &pix) const;
     int numberOfBlocks();
     inline bool update(quint32 block, bool creation=false);
+    void narrowBlocks(quint32 keep);
+    quint64 evict(quint32 block);
     void unloadInternal();
 
 
     std::recursive_mutex _mutex;
     std::vector< GridBlockInternal *> _blocks;
-    QList<quint32> _cache;
-    quint32 _inMemoryIndex;
     qint64 _memUsed;
+    IlwisTypes _storeType = itUNKNOWN;
     //quint64 _bandSize;
     quint32 _blocksPerBand;
     std::vector<quint32> _blockSizes;
@@ -134,7 +222,14 @@ private:
     quint32 _maxLines;
     std::vector<std::vector<quint32>> _offsets;
     std::vector<quint32> _blockOffsets;
+    std::unique_ptr<GridMappedFile> _mappedFile;
+    quint32 _prefetchDepth = 0;
     bool _allInMemory = false;
+    // blocks of rasters with a narrow value type that do not fit are resident packed; only the blocks in this working set are wide (doubles)
+    bool _narrowResident = false;
+    quint32 _wideLimit = 0;
+    std::deque<quint32> _wideBlocks;
+    std::vector<bool> _isWide;
 
 };
 
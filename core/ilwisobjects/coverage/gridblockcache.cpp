@@ -0,0 +1,158 @@
+#include "raster.h"
+#include "ilwiscontext.h"
+#include "grid.h"
+#include "gridblockcache.h"
+
+using namespace Ilwis;
+
+GridBlockCache *Ilwis::gridBlockCache()
+{
+    static GridBlockCache *cache = new GridBlockCache(); // never deleted, grids may outlive static destruction
+    return cache;
+}
+
+GridBlockCache::GridBlockCache()
+{
+    quint64 megabytes = ilwisconfig("system-settings/grid-cachesize", 0ULL);
+    if ( megabytes == 0)
+        _budget = context()->memoryLeft() / 2;
+    else
+        _budget = megabytes * 1024 * 1024;
+    context()->changeMemoryLeft(-(qint64)_budget);
+}
+
+void GridBlockCache::touch(GridBlockInternal *block)
+{
+    block->_referenced = true;
+    ++_hits;
+}
+
+void GridBlockCache::admit(Grid *grid, quint32 index, GridBlockInternal *block, quint64 bytes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_misses;
+    if ( block->_cacheSlot < 0) {
+        quint32 slot;
+        if ( _freeSlots.size() > 0) {
+            slot = _freeSlots.back();
+            _freeSlots.pop_back();
+        } else {
+            slot = _slots.size();
+            _slots.push_back(Slot());
+        }
+        _slots[slot]._grid = grid;
+        _slots[slot]._index = index;
+        _slots[slot]._block = block;
+        _slots[slot]._bytes = bytes;
+        block->_cacheSlot = slot;
+        _cachedBytes += bytes;
+    } else { // a packed block that became resident again
+        Slot& slot = _slots[block->_cacheSlot];
+        _cachedBytes = _cachedBytes - slot._bytes + bytes;
+        slot._bytes = bytes;
+    }
+    block->_referenced = true;
+    makeRoom(block);
+}
+
+void GridBlockCache::resize(GridBlockInternal *block, quint64 bytes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if ( block->_cacheSlot < 0)
+        return;
+    Slot& slot = _slots[block->_cacheSlot];
+    _cachedBytes = _cachedBytes - slot._bytes + bytes;
+    slot._bytes = bytes;
+}
+
+void GridBlockCache::remove(Grid *grid, bool keepPinned)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(quint32 i = 0; i < _slots.size(); ++i) {
+        Slot& slot = _slots[i];
+        if ( slot._grid != grid)
+            continue;
+        if ( keepPinned && slot._block->isPinned())
+            continue;
+        freeSlot(i);
+    }
+}
+
+bool GridBlockCache::reserve(quint64 bytes, bool force)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if ( !force && _reservedBytes + bytes > _budget / 2) // no single raster may take the cache away from the others
+        return false;
+    _reservedBytes += bytes;
+    makeRoom();
+    return true;
+}
+
+void GridBlockCache::release(quint64 bytes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _reservedBytes -= std::min(bytes, _reservedBytes);
+}
+
+quint64 GridBlockCache::budget() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _budget;
+}
+
+void GridBlockCache::budget(quint64 bytes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _budget = bytes;
+    makeRoom();
+}
+
+GridBlockCache::Statistics GridBlockCache::statistics() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    Statistics stats;
+    stats._hits = _hits;
+    stats._misses = _misses;
+    stats._evictions = _evictions;
+    stats._cachedBytes = _cachedBytes;
+    stats._reservedBytes = _reservedBytes;
+    stats._budget = _budget;
+    return stats;
+}
+
+void GridBlockCache::makeRoom(GridBlockInternal *keep)
+{
+    // two full turns of the clock: the first may only clear reference bits, the second finds the victims.
+    // blocks that are pinned or whose grid is busy in another thread are passed; if nothing can go the budget is exceeded temporarily
+    quint64 steps = 2 * _slots.size() + 1;
+    while ( _cachedBytes + _reservedBytes > _budget && steps-- > 0 && _slots.size() > 0) {
+        if ( _hand >= _slots.size())
+            _hand = 0;
+        quint32 current = _hand++;
+        Slot& slot = _slots[current];
+        if ( slot._grid == 0 || slot._block == keep || slot._block->isPinned())
+            continue;
+        if ( slot._block->_referenced.exchange(false)) // second chance
+            continue;
+        std::unique_lock<std::recursive_mutex> gridLock(slot._grid->_mutex, std::try_to_lock);
+        if ( !gridLock.owns_lock())
+            continue;
+        if ( slot._block->isPinned()) // pinned while we were getting the lock; pins are only taken under the grid lock
+            continue;
+        quint64 left = slot._grid->evict(slot._index);
+        ++_evictions;
+        _cachedBytes -= slot._bytes - left;
+        slot._bytes = left;
+        if ( left == 0)
+            freeSlot(current);
+    }
+}
+
+void GridBlockCache::freeSlot(quint32 index)
+{
+    Slot& slot = _slots[index];
+    _cachedBytes -= slot._bytes;
+    slot._block->_cacheSlot = -1;
+    slot = Slot();
+    _freeSlots.push_back(index);
+}
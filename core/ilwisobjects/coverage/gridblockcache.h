@@ -0,0 +1,74 @@
+#ifndef GRIDBLOCKCACHE_H
+#define GRIDBLOCKCACHE_H
+
+#include <mutex>
+#include <atomic>
+#include "kernel_global.h"
+
+namespace Ilwis {
+
+class Grid;
+class GridBlockInternal;
+
+/*!
+ * \brief The GridBlockCache class keeps track of all resident grid blocks of all rasters in the process
+ *
+ * Grids that do not fit entirely in memory have their blocks admitted to this cache when they are loaded. The cache
+ * shares one byte budget (system-settings/grid-cachesize in ilwis.config, in megabytes) between all of them and uses a CLOCK
+ * replacement to decide which block goes next. Eviction happens in two stages: a resident block is first packed in its native
+ * cell type (it stays in the cache with its smaller size) and only on a second round it is written to the swap file.
+ * Grids that do fit entirely reserve their memory up front and are not administered per block. Other grids of rasters with a narrow
+ * value type pack their blocks themselves when they leave the working set of the grid (see Grid::narrowBlocks()) and report the new size.
+ */
+class KERNELSHARED_EXPORT GridBlockCache
+{
+public:
+    struct Statistics {
+        quint64 _hits = 0;
+        quint64 _misses = 0;
+        quint64 _evictions = 0;
+        quint64 _cachedBytes = 0;
+        quint64 _reservedBytes = 0;
+        quint64 _budget = 0;
+    };
+
+    GridBlockCache();
+
+    void touch(GridBlockInternal *block);
+    void admit(Grid *grid, quint32 index, GridBlockInternal *block, quint64 bytes);
+    void resize(GridBlockInternal *block, quint64 bytes);
+    void remove(Grid *grid, bool keepPinned=false);
+    bool reserve(quint64 bytes, bool force=false);
+    void release(quint64 bytes);
+
+    quint64 budget() const;
+    void budget(quint64 bytes);
+    Statistics statistics() const;
+
+private:
+    struct Slot {
+        Grid *_grid = 0;
+        quint32 _index = 0;
+        GridBlockInternal *_block = 0;
+        quint64 _bytes = 0;
+    };
+
+    void makeRoom(GridBlockInternal *keep=0);
+    void freeSlot(quint32 slot);
+
+    mutable std::mutex _mutex;
+    std::vector<Slot> _slots;
+    std::vector<quint32> _freeSlots;
+    quint32 _hand = 0;
+    quint64 _budget = 0;
+    quint64 _cachedBytes = 0;
+    quint64 _reservedBytes = 0;
+    std::atomic<quint64> _hits{0};
+    std::atomic<quint64> _misses{0};
+    quint64 _evictions = 0;
+};
+
+KERNELSHARED_EXPORT GridBlockCache* gridBlockCache();
+}
+
+#endif // GRIDBLOCKCACHE_H
@@ -100,18 +100,61 @@ PixelIterator::PixelIterator(PixelIterator&& iter) :
     _zChanged(iter._zChanged),
     _selectionPixels(iter._selectionPixels),
     _selectionIndex(iter._selectionIndex),
-    _insideSelection (iter._insideSelection)
+    _insideSelection (iter._insideSelection),
+    _pinnedBlock(iter._pinnedBlock)
 
 
 {
+    iter._pinnedBlock = -1; // the pin now belongs to this iterator
 }
 
 PixelIterator::PixelIterator(const PixelIterator& iter)  {
     copy(iter);
 }
 
+PixelIterator::~PixelIterator()
+{
+    releasePin();
+}
+
+void PixelIterator::pinCurrentBlock() const
+{
+    // start of a scan or the next block of a sequential scan; read ahead
+    if ( _flow == fXYZ && (_pinnedBlock < 0 || _currentBlock == _pinnedBlock + 1))
+        _grid->prefetch(_currentBlock + 1);
+    releasePin();
+    if (!_grid->pin(_currentBlock))
+        throw ErrorObject(TR("Grid block is out of bounds"));
+    _pinnedBlock = _currentBlock;
+}
+
+void PixelIterator::releasePin() const
+{
+    if ( _pinnedBlock >= 0 && _grid)
+        _grid->unpin(_pinnedBlock);
+    _pinnedBlock = -1;
+}
+
+std::pair<double *, double *> PixelIterator::span()
+{
+    if ( _linearposition >= _endposition)
+        return std::pair<double *, double *>(0, 0);
+
+    double *first = &operator*(); // pins the block
+    if ( _flow != fXYZ || _selectionIndex >= 0)
+        return std::pair<double *, double *>(first, first + 1);
+
+    qint64 cells = _endx - _x + 1;
+    if ( _box.xlength() == _grid->size().xsize()) { // complete rows, the run goes on over the following lines of the block
+        qint32 lastLine = std::min(_endy, (_y / _grid->maxLines() + 1) * _grid->maxLines() - 1);
+        cells += (qint64)(lastLine - _y) * _grid->size().xsize();
+    }
+    return std::pair<double *, double *>(first, first + cells);
+}
+
 
 void PixelIterator::copy(const PixelIterator &iter) {
+    releasePin();
     _raster = iter._raster;
     if ( _raster.isValid())
         _grid = _raster->_grid.get();
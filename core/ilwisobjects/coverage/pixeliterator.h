@@ -127,6 +127,8 @@ public:
      */
     PixelIterator(PixelIterator &&iter);
 
+    ~PixelIterator();
+
     /*!
      * override of the operator=<br>
      * copies the values of the supplied iterator onto this one<br>
@@ -304,7 +306,9 @@ public:
      * \return reference to the currentvalue
      */
     double& operator*() {
-        return _grid->value(_currentBlock, _localOffset );
+        if ( _currentBlock != _pinnedBlock)
+            pinCurrentBlock();
+        return _grid->pinnedValue(_currentBlock, _localOffset );
     }
 
     /*!
@@ -312,7 +316,9 @@ public:
      * \return reference to the currentvalue
      */
     const double& operator*() const {
-        return  _grid->value(_currentBlock, _localOffset);
+        if ( _currentBlock != _pinnedBlock)
+            pinCurrentBlock();
+        return  _grid->pinnedValue(_currentBlock, _localOffset);
     }
 
     /*!
@@ -320,9 +326,27 @@ public:
      * \return ->value(this(current))
      */
     double* operator->() {
-        return &(_grid->value(_currentBlock, _localOffset ));
+        return &(operator*());
     }
 
+    /*!
+     * \brief Query for the run of cells that lie contiguous in memory from the current position onwards
+     *
+     * The run ends at the end of the current row of the box or, when the box covers complete rows of the raster, at the last line of
+     * the box in the current grid block. The pointers are valid until the iterator leaves the current block; the usual way of using it is
+     *
+     *    while(iter != iterEnd) {
+     *        auto run = iter.span();
+     *        for(double *v = run.first; v != run.second; ++v)
+     *            *v = ...;
+     *        iter += run.second - run.first;
+     *    }
+     *
+     * Iterators with a selection or another flow than fXYZ have runs of one cell. At the end the run is empty.
+     * \return begin and end (one beyond the last cell) of the run
+     */
+    std::pair<double*, double*> span();
+
     /*!
      * \brief Returns the end position of this PixelIterator, this is 1 past the actual lastblock of the boundingbox
      * \return the endvalue of the lineairposition
@@ -473,7 +497,11 @@ protected:
     std::vector<std::vector<qint32>> _selectionPixels;
     qint32 _selectionIndex = -1;
     bool _insideSelection = false;
+    // the block under the iterator is pinned in the grid so that cell access needs no locking; the pin moves along when the iterator crosses into another block
+    mutable qint32 _pinnedBlock = -1;
 
+    void pinCurrentBlock() const;
+    void releasePin() const;
 
     bool move(int n) {
 
@@ -1,3 +1,4 @@
+#include <cmath>
 #include "kernel.h"
 #include "geometries.h"
 #include "ilwisdata.h"
@@ -41,7 +42,7 @@ LatLon ConventionalCoordinateSystem::coord2latlon(const Coordinate &crdSource) c
     LatLon pl = _projection->coord2latlon(crdSource);
     if (!pl.isValid())
         return llUNDEF;
-    if (abs(pl.lon()) > 90)
+    if (std::abs(pl.y) > 90)
         return llUNDEF;
     return pl;
 }
@@ -55,6 +56,62 @@ Coordinate ConventionalCoordinateSystem::latlon2coord(const LatLon &ll) const
 
 }
 
+quint32 ConventionalCoordinateSystem::coord2coord(const ICoordinateSystem &sourceCs, double *x, double *y, quint32 count, quint8 *status) const
+{
+    if (sourceCs->id() == id()) {
+        quint32 converted = 0;
+        for(quint32 i = 0; i < count; ++i) {
+            bool ok = x[i] != rUNDEF && y[i] != rUNDEF;
+            if ( status)
+                status[i] = ok;
+            converted += ok;
+        }
+        return converted;
+    }
+    // through latlon as the single point version does, but every step for all points at once; failed points stay undefined
+    std::vector<quint8> valid;
+    if ( !status) {
+        valid.resize(count);
+        status = &valid[0];
+    }
+    quint32 converted = count;
+    if ( sourceCs->isLatLon()) {
+        converted = 0;
+        for(quint32 i = 0; i < count; ++i) {
+            status[i] = x[i] != rUNDEF && y[i] != rUNDEF;
+            converted += status[i];
+        }
+    } else
+        converted = sourceCs->coord2latlon(x, y, count, status);
+
+    if ( isLatLon() || converted == 0)
+        return converted;
+    return latlon2coord(x, y, count, status);
+}
+
+quint32 ConventionalCoordinateSystem::coord2latlon(double *x, double *y, quint32 count, quint8 *status) const
+{
+    std::vector<quint8> valid;
+    if ( !status) {
+        valid.resize(count);
+        status = &valid[0];
+    }
+    quint32 converted = _projection->coord2latlon(x, y, count, status);
+    for(quint32 i = 0; i < count; ++i) {
+        if ( status[i] && std::abs(y[i]) > 90) {
+            x[i] = y[i] = rUNDEF;
+            status[i] = false;
+            --converted;
+        }
+    }
+    return converted;
+}
+
+quint32 ConventionalCoordinateSystem::latlon2coord(double *x, double *y, quint32 count, quint8 *status) const
+{
+    return _projection->latlon2coord(x, y, count, status);
+}
+
 bool ConventionalCoordinateSystem::isEqual(const IlwisObject *obj) const
 {
     if ( !obj || !hasType(obj->ilwisType(), itCONVENTIONALCOORDSYSTEM))
@@ -23,6 +23,9 @@ public:
     Coordinate coord2coord(const ICoordinateSystem &sourceCs, const Coordinate& crdSource) const;
     LatLon coord2latlon(const Coordinate &crdSource) const;
     Coordinate latlon2coord(const LatLon& ll) const;
+    quint32 coord2coord(const ICoordinateSystem& sourceCs, double *x, double *y, quint32 count, quint8 *status=0) const;
+    quint32 coord2latlon(double *x, double *y, quint32 count, quint8 *status=0) const;
+    quint32 latlon2coord(double *x, double *y, quint32 count, quint8 *status=0) const;
     const std::unique_ptr<Ilwis::GeodeticDatum> &datum() const;
     void setDatum(Ilwis::GeodeticDatum *datum);
     IEllipsoid ellipsoid() const;
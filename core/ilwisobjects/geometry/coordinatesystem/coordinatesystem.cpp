@@ -16,6 +16,54 @@ CoordinateSystem::CoordinateSystem(const Resource& resource) : IlwisObject(resou
 {
 }
 
+quint32 CoordinateSystem::coord2coord(const ICoordinateSystem &sourceCs, double *x, double *y, quint32 count, quint8 *status) const
+{
+    quint32 converted = 0;
+    for(quint32 i = 0; i < count; ++i) {
+        Coordinate crd = coord2coord(sourceCs, Coordinate(x[i], y[i]));
+        bool ok = crd.isValid();
+        x[i] = ok ? crd.x : rUNDEF;
+        y[i] = ok ? crd.y : rUNDEF;
+        if ( status)
+            status[i] = ok;
+        converted += ok;
+    }
+    return converted;
+}
+
+quint32 CoordinateSystem::coord2latlon(double *x, double *y, quint32 count, quint8 *status) const
+{
+    quint32 converted = 0;
+    for(quint32 i = 0; i < count; ++i) {
+        LatLon ll = coord2latlon(Coordinate(x[i], y[i]));
+        bool ok = ll.isValid();
+        x[i] = ok ? ll.x : rUNDEF;
+        y[i] = ok ? ll.y : rUNDEF;
+        if ( status)
+            status[i] = ok;
+        converted += ok;
+    }
+    return converted;
+}
+
+quint32 CoordinateSystem::latlon2coord(double *x, double *y, quint32 count, quint8 *status) const
+{
+    quint32 converted = 0;
+    for(quint32 i = 0; i < count; ++i) {
+        LatLon ll;
+        ll.x = x[i];
+        ll.y = y[i];
+        Coordinate crd = ll.isValid() ? latlon2coord(ll) : Coordinate();
+        bool ok = crd.isValid();
+        x[i] = ok ? crd.x : rUNDEF;
+        y[i] = ok ? crd.y : rUNDEF;
+        if ( status)
+            status[i] = ok;
+        converted += ok;
+    }
+    return converted;
+}
+
 Envelope CoordinateSystem::convertEnvelope(const ICoordinateSystem &sourceCs, const Envelope &envelope) const
 {
     double rDX = envelope.xlength()/10.0;
@@ -19,6 +19,17 @@ public:
     virtual Coordinate coord2coord(const ICoordinateSystem& sourceCs, const Coordinate& crdSource) const =0;
     virtual LatLon coord2latlon(const Coordinate &crdSource) const =0;
     virtual Coordinate latlon2coord(const LatLon& ll) const = 0;
+    /*!
+     * \brief coord2coord converts count coordinates of sourceCs in one call
+     *
+     * x and y are replaced by the converted coordinates. A point that can not be converted (or was undefined to begin with) becomes
+     * undefined and gets a 0 in status (when given), the others get a 1; failures are not logged. This default converts point by point;
+     * coordinate systems that can do better override it. The latlon variants below use degrees, longitudes in x and latitudes in y.
+     * \return the number of points that were converted
+     */
+    virtual quint32 coord2coord(const ICoordinateSystem& sourceCs, double *x, double *y, quint32 count, quint8 *status=0) const;
+    virtual quint32 coord2latlon(double *x, double *y, quint32 count, quint8 *status=0) const;
+    virtual quint32 latlon2coord(double *x, double *y, quint32 count, quint8 *status=0) const;
     virtual Ilwis::Envelope convertEnvelope(const ICoordinateSystem& sourceCs, const Envelope& envelope) const;
     virtual bool canConvertToLatLon() const;
     virtual bool canConvertToCoordinate() const;
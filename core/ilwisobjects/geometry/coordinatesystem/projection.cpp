@@ -55,6 +55,46 @@ LatLon Projection::coord2latlon(const Coordinate &crd) const
 
 }
 
+quint32 Projection::latlon2coord(double *x, double *y, quint32 count, quint8 *status) const
+{
+    if ( !_implementation.isNull())
+        return _implementation->latlon2coord(x, y, count, status);
+
+    // projections without an implementation (e.g. the null projection) only know the single point version
+    quint32 converted = 0;
+    for(quint32 i = 0; i < count; ++i) {
+        LatLon ll;
+        ll.x = x[i];
+        ll.y = y[i];
+        Coordinate crd = ll.isValid() ? latlon2coord(ll) : Coordinate();
+        bool ok = crd.isValid();
+        x[i] = ok ? crd.x : rUNDEF;
+        y[i] = ok ? crd.y : rUNDEF;
+        if ( status)
+            status[i] = ok;
+        converted += ok;
+    }
+    return converted;
+}
+
+quint32 Projection::coord2latlon(double *x, double *y, quint32 count, quint8 *status) const
+{
+    if ( !_implementation.isNull())
+        return _implementation->coord2latlon(x, y, count, status);
+
+    quint32 converted = 0;
+    for(quint32 i = 0; i < count; ++i) {
+        LatLon ll = coord2latlon(Coordinate(x[i], y[i]));
+        bool ok = ll.isValid();
+        x[i] = ok ? ll.x : rUNDEF;
+        y[i] = ok ? ll.y : rUNDEF;
+        if ( status)
+            status[i] = ok;
+        converted += ok;
+    }
+    return converted;
+}
+
 bool Projection::prepare(const QString &parms)
 {
     return _implementation->prepare(parms);
@@ -24,6 +24,8 @@ public:
 
     virtual Coordinate latlon2coord(const LatLon&) const;
     virtual LatLon coord2latlon(const Coordinate&) const;
+    virtual quint32 latlon2coord(double *x, double *y, quint32 count, quint8 *status=0) const;
+    virtual quint32 coord2latlon(double *x, double *y, quint32 count, quint8 *status=0) const;
 
     bool prepare(const QString& parms);
     bool prepare();
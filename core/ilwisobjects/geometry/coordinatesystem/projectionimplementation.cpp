@@ -43,6 +43,39 @@ void ProjectionImplementation::setCoordinateSystem(ConventionalCoordinateSystem
     _coordinateSystem = csy;
 }
 
+quint32 ProjectionImplementation::latlon2coord(double *x, double *y, quint32 count, quint8 *status) const
+{
+    quint32 converted = 0;
+    for(quint32 i = 0; i < count; ++i) {
+        LatLon ll;
+        ll.x = x[i];
+        ll.y = y[i];
+        Coordinate crd = ll.isValid() ? latlon2coord(ll) : Coordinate();
+        bool ok = crd.isValid();
+        x[i] = ok ? crd.x : rUNDEF;
+        y[i] = ok ? crd.y : rUNDEF;
+        if ( status)
+            status[i] = ok;
+        converted += ok;
+    }
+    return converted;
+}
+
+quint32 ProjectionImplementation::coord2latlon(double *x, double *y, quint32 count, quint8 *status) const
+{
+    quint32 converted = 0;
+    for(quint32 i = 0; i < count; ++i) {
+        LatLon ll = Coordinate(x[i], y[i]).isValid() ? coord2latlon(Coordinate(x[i], y[i])) : LatLon();
+        bool ok = ll.isValid();
+        x[i] = ok ? ll.x : rUNDEF;
+        y[i] = ok ? ll.y : rUNDEF;
+        if ( status)
+            status[i] = ok;
+        converted += ok;
+    }
+    return converted;
+}
+
 QVariant ProjectionImplementation::parameter(Projection::ProjectionParamValue type) const
 {
     auto iter = _parameters.find(type);
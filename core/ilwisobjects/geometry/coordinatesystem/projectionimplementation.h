@@ -24,6 +24,16 @@ public:
 
     virtual Coordinate latlon2coord(const LatLon&) const = 0;
     virtual LatLon coord2latlon(const Coordinate&) const = 0;
+    /*!
+     * \brief latlon2coord projects count points in one call
+     *
+     * x holds the longitudes and y the latitudes (degrees); both are replaced by the projected coordinates. Points that can not be
+     * projected (or were undefined) become undefined and get a 0 in status (when given), the others a 1; nothing is logged per point.
+     * The default loops over the single point version.
+     * \return the number of points that were projected
+     */
+    virtual quint32 latlon2coord(double *x, double *y, quint32 count, quint8 *status=0) const;
+    virtual quint32 coord2latlon(double *x, double *y, quint32 count, quint8 *status=0) const;
     virtual bool prepare(const QString& parms="")=0;
     virtual QString type() const;
     virtual void setCoordinateSystem(ConventionalCoordinateSystem *csy);
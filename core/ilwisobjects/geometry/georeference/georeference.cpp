@@ -53,6 +53,17 @@ Pixeld GeoReference::coord2Pixel(const Coordinate &crd) const
     return _georefImpl->coord2Pixel(crd);
 }
 
+void GeoReference::pixel2Coord(double x, double y, quint32 count, double *crdx, double *crdy) const
+{
+    // for performance reasons no isValid check here, has to be checked before hand
+    _georefImpl->pixel2Coord(x, y, count, crdx, crdy);
+}
+
+void GeoReference::coord2Pixel(const double *crdx, const double *crdy, quint32 count, double *pixx, double *pixy) const
+{
+    _georefImpl->coord2Pixel(crdx, crdy, count, pixx, pixy);
+}
+
 double GeoReference::pixelSize() const
 {
     // for performance reasons no isValid check here, haas tobe checked before hand
@@ -38,6 +38,8 @@ public:
 
     virtual Envelope pixel2Coord(const BoundingBox &box ) const;
     virtual BoundingBox coord2Pixel(const Envelope &box) const;
+    void pixel2Coord(double x, double y, quint32 count, double *crdx, double *crdy) const;
+    void coord2Pixel(const double *crdx, const double *crdy, quint32 count, double *pixx, double *pixy) const;
     ICoordinateSystem coordinateSystem() const;
     void coordinateSystem(const ICoordinateSystem& csy);
     Size<> size() const;
@@ -61,3 +61,23 @@ bool GeoRefImplementation::isCompatible(const IGeoReference &georefOther) const
 {
     return false;
 }
+
+void GeoRefImplementation::pixel2Coord(double x, double y, quint32 count, double *crdx, double *crdy) const
+{
+    for(quint32 i = 0; i < count; ++i) {
+        Coordinate crd = pixel2Coord(Pixeld(x + i, y));
+        crdx[i] = crd.isValid() ? crd.x : rUNDEF;
+        crdy[i] = crd.isValid() ? crd.y : rUNDEF;
+    }
+}
+
+void GeoRefImplementation::coord2Pixel(const double *crdx, const double *crdy, quint32 count, double *pixx, double *pixy) const
+{
+    for(quint32 i = 0; i < count; ++i) {
+        Pixeld pix;
+        if ( crdx[i] != rUNDEF && crdy[i] != rUNDEF)
+            pix = coord2Pixel(Coordinate(crdx[i], crdy[i]));
+        pixx[i] = pix.isValid() ? pix.x : rUNDEF;
+        pixy[i] = pix.isValid() ? pix.y : rUNDEF;
+    }
+}
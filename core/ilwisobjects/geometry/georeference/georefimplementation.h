@@ -15,6 +15,21 @@ public:
     void centerOfPixel(bool yesno);
     bool compute();
     virtual bool isCompatible(const IGeoReference &georefOther) const;
+
+    using GeoRefInterface::pixel2Coord;
+    using GeoRefInterface::coord2Pixel;
+    /*!
+     * \brief pixel2Coord computes the coordinates of count pixel positions on one row; x, x + 1 .. x + count - 1 at row y
+     *
+     * The default implementation converts pixel by pixel; implementations with a simpler (e.g. affine) mapping step along the row.
+     */
+    virtual void pixel2Coord(double x, double y, quint32 count, double *crdx, double *crdy) const;
+    /*!
+     * \brief coord2Pixel computes the pixel positions of count coordinates, undefined coordinates give undefined pixels
+     *
+     * The output arrays may be the same as the input arrays.
+     */
+    virtual void coord2Pixel(const double *crdx, const double *crdy, quint32 count, double *pixx, double *pixy) const;
 protected:
 
     ICoordinateSystem _csy;
@@ -1,4 +1,5 @@
 #include <QString>
+#include <algorithm>
 
 #include "kernel.h"
 #include "ilwis.h"
@@ -79,7 +80,7 @@ Pixeld PlanarCTPGeoReference::coord2Pixel(const Coordinate &crd) const
     switch (_transformation) {
     case tTHIRDORDER:
         rc += {(_colrowCoef[6]._x * c.x + _colrowCoef[7]._x * c.y) * X2 + (_colrowCoef[8]._x * c.x + _colrowCoef[9]._x * c.y) * Y2,
-                (_colrowCoef[6]._y * c.x + _colrowCoef[7]._y * c.y) * X2 +(_colrowCoef[8]._y * c.x + _colrowCoef[9]._x * c.y) * Y2};
+                (_colrowCoef[6]._y * c.x + _colrowCoef[7]._y * c.y) * X2 +(_colrowCoef[8]._y * c.x + _colrowCoef[9]._y * c.y) * Y2};
     case tFULLSECONDORDER:
         rc += {_colrowCoef[4]._x * X2 + _colrowCoef[5]._x * Y2, _colrowCoef[4]._y * X2 + _colrowCoef[5]._y * Y2};
     case tSECONDORDER:
@@ -102,6 +103,79 @@ Pixeld PlanarCTPGeoReference::coord2Pixel(const Coordinate &crd) const
     return rc;
 }
 
+void PlanarCTPGeoReference::pixel2Coord(double x, double y, quint32 count, double *crdx, double *crdy) const
+{
+    // only the affine inverse is linear; the projective and polynomial inverses stay per pixel
+    if ( (_transformation != tAFFINE && _transformation != tCONFORM) || count < 2) {
+        GeoRefImplementation::pixel2Coord(x, y, count, crdx, crdy);
+        return;
+    }
+    Coordinate crd0 = pixel2Coord(Pixeld(x, y));
+    Coordinate crd1 = pixel2Coord(Pixeld(x + 1, y));
+    if ( !crd0.isValid() || !crd1.isValid()) {
+        std::fill(crdx, crdx + count, rUNDEF);
+        std::fill(crdy, crdy + count, rUNDEF);
+        return;
+    }
+    double dx = crd1.x - crd0.x;
+    double dy = crd1.y - crd0.y;
+    for(quint32 i = 0; i < count; ++i) {
+        crdx[i] = crd0.x + i * dx;
+        crdy[i] = crd0.y + i * dy;
+    }
+}
+
+void PlanarCTPGeoReference::coord2Pixel(const double *crdx, const double *crdy, quint32 count, double *pixx, double *pixy) const
+{
+    if ( !isValid() || _transformation == tUNKNOWN || _colrowCoef.size() < 10) {
+        std::fill(pixx, pixx + count, rUNDEF);
+        std::fill(pixy, pixy + count, rUNDEF);
+        return;
+    }
+    // same polynomials as the single coordinate version, but the coefficients are fetched once for the whole array
+    double kc[10], kr[10];
+    for(int i = 0; i < 10; ++i) {
+        kc[i] = _colrowCoef[i]._x;
+        kr[i] = _colrowCoef[i]._y;
+    }
+    double avgX = _avgCrd._x, avgY = _avgCrd._y;
+    double avgCol = _avgPix._x, avgRow = _avgPix._y;
+    for(quint32 i = 0; i < count; ++i) {
+        if ( crdx[i] == rUNDEF || crdy[i] == rUNDEF) {
+            pixx[i] = pixy[i] = rUNDEF;
+            continue;
+        }
+        double X = crdx[i] - avgX;
+        double Y = crdy[i] - avgY;
+        double col = avgCol, row = avgRow;
+        double X2 = X * X, Y2 = Y * Y, XY = X * Y;
+        switch (_transformation) {
+        case tTHIRDORDER:
+            col += (kc[6] * X + kc[7] * Y) * X2 + (kc[8] * X + kc[9] * Y) * Y2;
+            row += (kr[6] * X + kr[7] * Y) * X2 + (kr[8] * X + kr[9] * Y) * Y2;
+        case tFULLSECONDORDER:
+            col += kc[4] * X2 + kc[5] * Y2;
+            row += kr[4] * X2 + kr[5] * Y2;
+        case tSECONDORDER:
+            col += kc[3] * XY;
+            row += kr[3] * XY;
+        case tAFFINE:
+        case tCONFORM:
+            col += kc[0] + kc[1] * X + kc[2] * Y;
+            row += kr[0] + kr[1] * X + kr[2] * Y;
+            break;
+        case tPROJECTIVE:
+            col += (kc[0] * X + kc[1] * Y + kc[2]) / (kr[6] * X + kr[7] * Y + 1);
+            row += (kc[3] * X + kc[4] * Y + kc[5]) / (kr[6] * X + kr[7] * Y + 1);
+            break;
+        default:
+            break;
+        }
+        pixx[i] = col;
+        pixy[i] = row;
+    }
+}
+
 Coordinate PlanarCTPGeoReference::crdInverseOfAffine(const Pixeld& pix) const
 {
     // Solving the following Coord2RowCol equations for X and Y:
@@ -115,7 +189,7 @@ Coordinate PlanarCTPGeoReference::crdInverseOfAffine(const Pixeld& pix) const
     //    detY = (Row -h)a - (Col -c)f
     // yields X = detX/det and Y = detY / det  provided  det <> 0
     double a = _colrowCoef[1]._x;
-    double b = _colrowCoef[2]._y;
+    double b = _colrowCoef[2]._x;
     double c = _colrowCoef[0]._x;
     double f = _colrowCoef[1]._y;
     double g = _colrowCoef[2]._y;
@@ -16,6 +16,8 @@ public:
     PlanarCTPGeoReference(const Resource& resource);
     virtual Coordinate pixel2Coord(const Pixeld &pix) const;
     virtual Pixeld coord2Pixel(const Coordinate& crd) const;
+    virtual void pixel2Coord(double x, double y, quint32 count, double *crdx, double *crdy) const;
+    virtual void coord2Pixel(const double *crdx, const double *crdy, quint32 count, double *pixx, double *pixy) const;
     bool isValid() const;
     virtual double pixelSize() const;
     virtual bool compute();
@@ -1,4 +1,5 @@
 #include <QString>
+#include <algorithm>
 
 #include "kernel.h"
 #include "geometries.h"
@@ -48,6 +49,38 @@ Pixeld SimpelGeoReference::coord2Pixel(const Coordinate &crd) const
     return pix;
 }
 
+void SimpelGeoReference::pixel2Coord(double x, double y, quint32 count, double *crdx, double *crdy) const
+{
+    if ( _det == 0) {
+        std::fill(crdx, crdx + count, rUNDEF);
+        std::fill(crdy, crdy + count, rUNDEF);
+        return;
+    }
+    // the mapping is affine, so along a row the coordinate moves by a constant step per pixel
+    double x0 = (_a22 * (x - _b1) - _a12 * (y - _b2)) / _det;
+    double y0 = (-_a21 * (x - _b1) + _a11 * (y - _b2)) / _det;
+    double dx = _a22 / _det;
+    double dy = -_a21 / _det;
+    for(quint32 i = 0; i < count; ++i) {
+        crdx[i] = x0 + i * dx;
+        crdy[i] = y0 + i * dy;
+    }
+}
+
+void SimpelGeoReference::coord2Pixel(const double *crdx, const double *crdy, quint32 count, double *pixx, double *pixy) const
+{
+    for(quint32 i = 0; i < count; ++i) {
+        double cx = crdx[i];
+        double cy = crdy[i];
+        if ( cx == rUNDEF || cy == rUNDEF) {
+            pixx[i] = pixy[i] = rUNDEF;
+            continue;
+        }
+        pixx[i] = _a11 * cx + _a12 * cy + _b1;
+        pixy[i] = _a21 * cx + _a22 * cy + _b2;
+    }
+}
+
 double SimpelGeoReference::pixelSize() const
 {
     if ( _det == 0)
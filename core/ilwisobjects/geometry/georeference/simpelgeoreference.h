@@ -12,6 +12,8 @@ public:
     static GeoRefImplementation * create();
      virtual Coordinate pixel2Coord(const Pixeld&) const;
     virtual Pixeld coord2Pixel(const Coordinate& crd) const;
+    virtual void pixel2Coord(double x, double y, quint32 count, double *crdx, double *crdy) const;
+    virtual void coord2Pixel(const double *crdx, const double *crdy, quint32 count, double *pixx, double *pixy) const;
     virtual double pixelSize() const;
     bool isCompatible(const IGeoReference &georefOther) const;
 
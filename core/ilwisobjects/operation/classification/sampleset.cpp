@@ -1,5 +1,7 @@
 #include "kernel.h"
 #include "raster.h"
+#include "pixeliterator.h"
+#include "bandvectoriterator.h"
 #include "featurespace.h"
 #include "thematicitem.h"
 #include "itemdomain.h"
@@ -98,9 +100,8 @@ bool SampleSet::prepare()
 
     BoundingBox box = _sampleMaps->size();
     PixelIterator iterSampleMap(_sampleMap);
-    PixelIterator iterBands(_sampleMaps);
-    iterBands.setFlow(PixelIterator::fZXY);
-    PixelIterator iterBandsEnd = iterBands.end();
+    BandVectorIterator iterBands(_sampleMaps);
+    BandVectorIterator iterBandsEnd = iterBands.end();
     int nrOfBands = _sampleMaps->size().zsize();
 
     _sampleHistogram->prepare(_sampleDomain, _sampleMaps);
@@ -112,12 +113,7 @@ bool SampleSet::prepare()
         Raw raw = *iterSampleMap;
         if ( raw != rUNDEF)  {
 
-            std::vector<double> zcolumn(nrOfBands, rUNDEF);
-
-            for(double& v : zcolumn){
-                v = *iterBands;
-                ++iterBands;
-            }
+            const double *zcolumn = *iterBands;
             for( int band = 0 ; band < nrOfBands; ++band){
 
                 // init _sampleHistogram:
@@ -136,9 +132,8 @@ bool SampleSet::prepare()
 
             }
             _sampleSum->at(raw, box.zlength())++;
-        }else
-            iterBands += nrOfBands;
-        //++iterBands;
+        }
+        ++iterBands;
         ++iterSampleMap;
     }
 
@@ -27,6 +27,7 @@ void ExecutionContext::clear(bool resultsOnly)
 
     _results.clear();
     _additionalInfo.clear();
+    _cancelled = false;
     if (!resultsOnly) {
         _masterCsy = sUNDEF;
         _masterGeoref = sUNDEF;
@@ -34,6 +35,7 @@ void ExecutionContext::clear(bool resultsOnly)
         _threaded = true;
         _out = &std::cout;
         _useAdditionalParameters = false;
+        _deferStatistics = false;
     }
 }
 
@@ -42,6 +44,28 @@ ExecutionContext::ExecutionContext(bool threaded) {
     _threaded = threaded;
 }
 
+ExecutionContext::ExecutionContext(const ExecutionContext &ctx)
+{
+    operator=(ctx);
+}
+
+ExecutionContext &ExecutionContext::operator=(const ExecutionContext &ctx)
+{
+    // spelled out because the atomic flag has no copy of its own
+    _silent = ctx._silent;
+    _threaded = ctx._threaded;
+    _useAdditionalParameters = ctx._useAdditionalParameters;
+    _cancelled = ctx._cancelled.load();
+    _deferStatistics = ctx._deferStatistics;
+    _scope = ctx._scope;
+    _results = ctx._results;
+    _additionalInfo = ctx._additionalInfo;
+    _masterGeoref = ctx._masterGeoref;
+    _masterCsy = ctx._masterCsy;
+    _out = ctx._out;
+    return *this;
+}
+
 void ExecutionContext::setOutput(SymbolTable &tbl, const QVariant &var, const QString &nme, quint64 tp, const Resource& resource, const QString& addInfo)
 {
     QString name =  nme == sUNDEF ? SymbolTable::newAnonym() : nme;
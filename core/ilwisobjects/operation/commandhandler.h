@@ -5,6 +5,7 @@
 #include <QVector>
 #include <QVariant>
 #include <map>
+#include <atomic>
 #include "kernel_global.h"
 #include "ilwis.h"
 #include "symboltable.h"
@@ -20,9 +21,13 @@ typedef std::function<OperationImplementation *(quint64 metaid, const OperationE
 struct KERNELSHARED_EXPORT ExecutionContext {
     void clear(bool resultsOnly=false);
     ExecutionContext(bool threaded=false);
+    ExecutionContext(const ExecutionContext& ctx);
+    ExecutionContext& operator=(const ExecutionContext& ctx);
     bool _silent = false;
     bool _threaded = false;
     bool _useAdditionalParameters = false;
+    std::atomic<bool> _cancelled{false}; // set by any thread, polled by running raster operations between tiles
+    bool _deferStatistics = false; // raster operations leave the output range alone; statistics are calculated when asked for
     qint16 _scope=1000;
     std::vector<QString> _results;
     std::map<QString, QString> _additionalInfo;
@@ -13,6 +13,7 @@
 #include "pixeliterator.h"
 #include "containerstatistics.h"
 #include "operationhelper.h"
+#include "tilescheduler.h"
 #include "operationhelpergrid.h"
 
 
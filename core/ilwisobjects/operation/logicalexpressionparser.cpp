@@ -22,18 +22,20 @@ bool LogicalExpressionParser::parse(const QString &ex)
     while(index != -1) {
         int shift = 0;
         LogicalOperator oper = loNONE;
-        int newindex = expr.indexOf(" and ", index);
-        if (newindex == -1){
-            newindex = expr.indexOf(" or ", index);
-            if ( newindex != -1){
-                oper = loOR;
-                shift = 3;
-            }
-        }else{
+        // the connector that comes first ends the part
+        int andindex = expr.indexOf(" and ", index);
+        int orindex = expr.indexOf(" or ", index);
+        int newindex = -1;
+        if ( andindex != -1 && (orindex == -1 || andindex < orindex)){
+            newindex = andindex;
             oper = loAND;
             shift = 4;
+        } else if ( orindex != -1){
+            newindex = orindex;
+            oper = loOR;
+            shift = 3;
         }
-        LogicalExpressionPart part(ex.mid(index, newindex != -1 ? newindex : ex.size()));
+        LogicalExpressionPart part(ex.mid(index, newindex != -1 ? newindex - index : -1));
         if ( !part.isValid()){
             _parts.clear();
             return ERROR2(ERR_ILLEGAL_VALUE_2,TR("expression"), ex);
@@ -61,9 +63,10 @@ LogicalExpressionPart::LogicalExpressionPart(const QString &ex)
 {
     QString expr = ex.trimmed();
     typedef std::pair<QString, LogicalOperator> CondP;
-    std::map<QString, LogicalOperator> conditions = {CondP("<=", loLESSEQ),CondP(">=", loGREATEREQ),
-                                                     CondP("!=", loNEQ),CondP("==", loEQ),
-                                                     CondP("<", loLESS),CondP(">", loGREATER)};
+    // the two character conditions go first, else "<=" would be found as "<"
+    std::vector<CondP> conditions = {CondP("<=", loLESSEQ),CondP(">=", loGREATEREQ),
+                                     CondP("!=", loNEQ),CondP("==", loEQ),
+                                     CondP("<", loLESS),CondP(">", loGREATER)};
     for(auto condition : conditions) {
         int index = -1;
         if ( (index = expr.indexOf(condition.first)) != -1){
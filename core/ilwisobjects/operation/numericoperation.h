@@ -38,6 +38,8 @@ protected:
         }
         return rUNDEF;
     }
+    void calc(const double *v1, const double *v2, double *result, quint32 count) const;
+    void calc(double number, const double *values, double *result, quint32 count, bool numberFirst) const;
 
     double _number1 = rUNDEF;
     double _number2 = rUNDEF;
@@ -7,6 +7,7 @@
 #include "connectorinterface.h"
 #include "symboltable.h"
 #include "ilwisoperation.h"
+#include "ilwiscontext.h"
 
 #include <QThread>
 using namespace Ilwis;
@@ -101,24 +102,97 @@ int OperationHelperRaster::subdivideTasks(ExecutionContext *ctx,const IRasterCov
         cores = 1;
 
     boxes.clear();
-    boxes.resize(cores);
     BoundingBox bounds = bnds;
     if ( bounds.isNull())
         bounds = BoundingBox(raster->size());
     int left = 0; //bounds.min_corner().x;
     int right = bounds.size().xsize();
     int top = bounds.size().ysize();
-    int step = bounds.size().ysize() / cores;
-    int currentY = 0;
+    if ( cores == 1) { // unthreaded operations expect exactly one box covering everything
+        boxes.push_back(BoundingBox(Pixel(left, 0, 0), Pixel(right - 1, top - 1, bounds.zlength())));
+        return cores;
+    }
 
-    for(int i=0 ; i < cores; ++i){
-        BoundingBox smallBox(Pixel(left, currentY,0), Pixel(right - 1, std::min(top - 1,currentY + step),bounds.zlength()) );
-        boxes[i] = smallBox;
-        currentY = currentY + step  ;
+    // tiles are whole-width strips of complete grid blocks (system-settings/tile-size lines, rounded up to blocks);
+    // small rasters are cut finer so every thread gets a few tiles and the scheduler has something to balance, but never
+    // across a block boundary: the tile height stays an exact divisor of the block height, fewer tiles are accepted instead
+    int blockLines = raster->gridRef()->maxLines();
+    int tileLines = ilwisconfig("system-settings/tile-size", 0);
+    if ( tileLines <= 0)
+        tileLines = blockLines;
+    else
+        tileLines = ((tileLines + blockLines - 1) / blockLines) * blockLines;
+    if ( top / tileLines < cores * 4) {
+        int wanted = std::max(1, top / (cores * 4));
+        if ( wanted >= blockLines)
+            tileLines = (wanted / blockLines) * blockLines;
+        else {
+            int divisor = wanted;
+            while ( blockLines % divisor != 0)
+                --divisor;
+            // a block height with no divisor near the wanted one (e.g. a prime) would give very thin tiles; whole blocks then
+            tileLines = divisor * 2 > wanted ? divisor : blockLines;
+        }
+    }
+
+    for(int currentY = 0; currentY < top; currentY += tileLines) {
+        boxes.push_back(BoundingBox(Pixel(left, currentY, 0), Pixel(right - 1, std::min(top - 1, currentY + tileLines - 1), bounds.zlength())));
     }
     return cores;
 }
 
+bool OperationHelperRaster::execute(ExecutionContext *ctx, const BoxedStatisticsFunc &func, IRasterCoverage &outputRaster, const BoundingBox &bounds)
+{
+    bool numeric = outputRaster.isValid() && (outputRaster->datadef().domain<>()->valueType() & itNUMERIC);
+    if ( !numeric || ctx->_deferStatistics || !(bounds.isNull() || bounds.size() == outputRaster->size())) {
+        BoxedAsyncFunc boxedFunc = [&](const BoundingBox& box) -> bool {
+            NumericStatistics::Partial markers;
+            return func(box, markers);
+        };
+        return execute(ctx, boxedFunc, outputRaster, bounds);
+    }
+
+    std::vector<BoundingBox> strips;
+    int cores = OperationHelperRaster::subdivideTasks(ctx,outputRaster,bounds, strips);
+    if ( cores == iUNDEF)
+        return false;
+
+    // every strip is cut into its bands, band by band, so merging the markers of the tiles in order follows the raster
+    // in the order of a PixelIterator over the whole of it; each tile fills its own markers
+    qint32 zmax = std::min((qint32)strips.front().max_corner().z, (qint32)outputRaster->size().zsize() - 1);
+    std::vector<BoundingBox> boxes;
+    for(qint32 z = strips.front().min_corner().z; z <= zmax; ++z) {
+        for(const BoundingBox& strip : strips)
+            boxes.push_back(BoundingBox(Pixel(strip.min_corner().x, strip.min_corner().y, z), Pixel(strip.max_corner().x, strip.max_corner().y, z)));
+    }
+    std::vector<NumericStatistics::Partial> markers(boxes.size());
+    qint32 stripLines = strips.front().ylength();
+    BoxedAsyncFunc boxedFunc = [&](const BoundingBox& box) -> bool {
+        quint32 tile = (box.min_corner().z - strips.front().min_corner().z) * strips.size() + box.min_corner().y / stripLines;
+        return func(box, markers[tile]);
+    };
+    if (!tilescheduler()->execute(boxes, cores, boxedFunc, ctx))
+        return false;
+
+    NumericStatistics::Partial merged;
+    for(const NumericStatistics::Partial& tileMarkers : markers)
+        merged.merge(tileMarkers);
+    NumericStatistics& stats = outputRaster->statistics(NumericStatistics::pNONE);
+    stats.calculate(merged);
+    setRange(outputRaster, stats);
+
+    return true;
+}
+
+void OperationHelperRaster::setRange(IRasterCoverage &outputRaster, const NumericStatistics &stats)
+{
+    if ( !stats.isValid())
+        return;
+
+    NumericRange *rng = new NumericRange(stats[NumericStatistics::pMIN], stats[NumericStatistics::pMAX], std::pow(10,-stats.significantDigits()));
+    outputRaster->datadefRef().range(rng);
+}
+
 bool OperationHelperRaster::resample(IRasterCoverage& raster1, IRasterCoverage& raster2, ExecutionContext *ctx) {
     if ( !raster1.isValid())
         return false;
@@ -3,8 +3,8 @@
 
 namespace Ilwis {
 
-typedef  std::function<bool(const BoundingBox&)> BoxedAsyncFunc;
 class Parameter;
+typedef std::function<bool(const BoundingBox&, NumericStatistics::Partial&)> BoxedStatisticsFunc;
 
 class KERNELSHARED_EXPORT OperationHelperRaster
 {
@@ -22,29 +22,29 @@ public:
         if ( cores == iUNDEF)
             return false;
 
-        std::vector<std::future<bool>> futures(cores);
-        bool res = true;
+        BoxedAsyncFunc boxedFunc = func;
+        bool res = tilescheduler()->execute(boxes, cores, boxedFunc, ctx);
 
-        for(int i =0; i < cores; ++i) {
-            futures[i] = std::async(std::launch::async, func, boxes[i]);
-        }
-
-        for(int i =0; i < cores; ++i) {
-            res &= futures[i].get();
-        }
-
-        if ( res && outputRaster.isValid()) {
-            if ( outputRaster->datadef().domain<>()->valueType() & itNUMERIC) {
-                NumericStatistics stats;
-                PixelIterator iter(outputRaster);
-                stats.calculate(iter, iter.end());
-                NumericRange *rng = new NumericRange(stats[NumericStatistics::pMIN], stats[NumericStatistics::pMAX], std::pow(10,-stats.significantDigits()));
-                outputRaster->datadefRef().range(rng);
-            }
+        if ( res && outputRaster.isValid() && (outputRaster->datadef().domain<>()->valueType() & itNUMERIC) && !ctx->_deferStatistics) {
+            NumericStatistics& stats = outputRaster->statistics(NumericStatistics::pNONE);
+            PixelIterator iter(outputRaster);
+            stats.calculate(iter, iter.end());
+            setRange(outputRaster, stats);
         }
         return res;
     }
+    /*!
+     * \brief execute runs a tile function that feeds every value it writes to the Partial it gets with the tile
+     *
+     * The output statistics then come without an extra pass over the raster. When the tiles cover the whole output they hold a
+     * single band each and their markers are merged in raster order afterwards; otherwise the markers are ignored and the
+     * statistics are calculated as for any other tile function.
+     */
+    static bool execute(ExecutionContext* ctx, const BoxedStatisticsFunc& func, IRasterCoverage& outputRaster, const BoundingBox& bounds=BoundingBox());
     static IIlwisObject initialize(const IIlwisObject &inputObject, IlwisTypes tp, quint64 what);
+
+private:
+    static void setRange(IRasterCoverage& outputRaster, const NumericStatistics& stats);
 };
 }
 
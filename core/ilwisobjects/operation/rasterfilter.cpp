@@ -1,5 +1,9 @@
 #include <QSqlQuery>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include "raster.h"
+#include "numericrange.h"
 #include "pixeliterator.h"
 #include "blockiterator.h"
 #include "rasterfilter.h"
@@ -15,6 +19,66 @@ bool RasterFilter::isValid() const
     return _valid;
 }
 
+//-------------------------------------
+FilterLines::FilterLines(const IRasterCoverage &raster, const QSize &filterSize, qint32 z) :
+    _raster(raster),
+    _dx(filterSize.width() / 2),
+    _dy(filterSize.height() / 2),
+    _z(z)
+{
+    _xsize = _raster->size().xsize();
+    _ysize = _raster->size().ysize();
+    _buffers.resize(filterSize.height(), std::vector<double>(_xsize + 2 * _dx));
+    _loaded.resize(filterSize.height(), iUNDEF);
+}
+
+quint32 FilterLines::slot(qint32 y) const
+{
+    qint32 rows = _buffers.size();
+    return ((y % rows) + rows) % rows;
+}
+
+void FilterLines::moveTo(qint32 y)
+{
+    for(qint32 ly = y - _dy; ly <= y + _dy; ++ly) {
+        qint32 clamped = std::max(0, std::min(ly, _ysize - 1));
+        quint32 index = slot(ly);
+        if ( _loaded[index] != clamped) {
+            load(clamped, _buffers[index]);
+            _loaded[index] = clamped;
+        }
+    }
+    _current = y;
+}
+
+const double *FilterLines::line(quint32 row) const
+{
+    return &_buffers[slot(_current - _dy + row)][0];
+}
+
+quint32 FilterLines::xsize() const
+{
+    return _xsize;
+}
+
+void FilterLines::load(qint32 y, std::vector<double> &buffer)
+{
+    PixelIterator iter(_raster, BoundingBox(Pixel(0, y, _z), Pixel(_xsize - 1, y, _z)));
+    PixelIterator iterEnd = iter.end();
+    double *target = &buffer[_dx];
+    while(iter != iterEnd) {
+        auto run = iter.span();
+        qint64 cells = run.second - run.first;
+        if ( cells == 0)
+            break;
+        std::copy(run.first, run.second, target);
+        target += cells;
+        iter += cells;
+    }
+    std::fill(buffer.begin(), buffer.begin() + _dx, buffer[_dx]);
+    std::fill(buffer.end() - _dx, buffer.end(), buffer[_dx + _xsize - 1]);
+}
+
 //-------------------------------------
 LinearGridFilter::LinearGridFilter(const QString &name)
 {
@@ -45,7 +109,9 @@ bool LinearGridFilter::definition(const QString &name)
                                 _filterdef[y][x] = v;
                             }
                         }
-                        _valid = true;
+                        _valid = ok1;
+                        if ( _valid)
+                            analyze();
                     }
                 }
             }
@@ -72,6 +138,140 @@ double LinearGridFilter::applyTo(const GridBlock& block)
     return v;
 }
 
+void LinearGridFilter::analyze()
+{
+    // the kernel is separable if it is (within rounding) the outer product of one of its columns and one of its rows;
+    // those are taken through the largest weight so the division is well conditioned
+    quint32 pivotx = 0, pivoty = 0;
+    bool allEqual = true;
+    for(quint32 y=0; y < _rows; ++y){
+        for(quint32 x=0; x < _columns; ++x){
+            if ( std::abs(_filterdef[y][x]) > std::abs(_filterdef[pivoty][pivotx])) {
+                pivotx = x;
+                pivoty = y;
+            }
+            allEqual = allEqual && _filterdef[y][x] == _filterdef[0][0];
+        }
+    }
+    double pivot = _filterdef[pivoty][pivotx];
+    _kernelType = ktGENERAL;
+    if ( pivot == 0 || (_rows == 1 && _columns == 1))
+        return;
+
+    _columnWeights.resize(_rows);
+    _rowWeights.resize(_columns);
+    for(quint32 y=0; y < _rows; ++y)
+        _columnWeights[y] = _filterdef[y][pivotx] / pivot;
+    for(quint32 x=0; x < _columns; ++x)
+        _rowWeights[x] = _filterdef[pivoty][x];
+    for(quint32 y=0; y < _rows; ++y){
+        for(quint32 x=0; x < _columns; ++x){
+            if ( std::abs(_filterdef[y][x] - _columnWeights[y] * _rowWeights[x]) > EPS10 * std::abs(pivot))
+                return;
+        }
+    }
+    _kernelType = allEqual ? ktBOX : ktSEPARABLE;
+}
+
+LinearGridFilter::KernelType LinearGridFilter::kernelType() const
+{
+    return _kernelType;
+}
+
+void LinearGridFilter::applyTo(const FilterLines &lines, double *result) const
+{
+    switch(_kernelType){
+    case ktBOX:
+        applyBox(lines, result); break;
+    case ktSEPARABLE:
+        applySeparable(lines, result); break;
+    default:
+        applyGeneral(lines, result); break;
+    }
+}
+
+void LinearGridFilter::applyGeneral(const FilterLines &lines, double *result) const
+{
+    quint32 xsize = lines.xsize();
+    std::vector<double> sums(xsize, 0);
+    std::vector<char> undefs(xsize, false);
+    for(quint32 y=0; y < _rows; ++y) {
+        const double *line = lines.line(y);
+        for(quint32 k=0; k < _columns; ++k) {
+            double weight = _filterdef[y][k];
+            const double *taps = line + k;
+            for(quint32 x=0; x < xsize; ++x) {
+                double v = taps[x];
+                undefs[x] |= isNumericalUndef(v);
+                sums[x] += v * weight;
+            }
+        }
+    }
+    for(quint32 x=0; x < xsize; ++x)
+        result[x] = undefs[x] ? rUNDEF : sums[x] * _gain;
+}
+
+void LinearGridFilter::applySeparable(const FilterLines &lines, double *result) const
+{
+    // vertical pass over the padded lines; undefined values become NaN so they poison every sum they take part in
+    quint32 xsize = lines.xsize();
+    quint32 padded = xsize + _columns - 1;
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> columns(padded, 0);
+    for(quint32 y=0; y < _rows; ++y) {
+        const double *line = lines.line(y);
+        double weight = _columnWeights[y];
+        for(quint32 x=0; x < padded; ++x) {
+            double v = line[x];
+            columns[x] += (isNumericalUndef(v) ? nan : v) * weight;
+        }
+    }
+    for(quint32 x=0; x < xsize; ++x)
+        result[x] = 0;
+    for(quint32 k=0; k < _columns; ++k) {
+        double weight = _rowWeights[k] * _gain;
+        const double *taps = &columns[k];
+        for(quint32 x=0; x < xsize; ++x)
+            result[x] += taps[x] * weight;
+    }
+    for(quint32 x=0; x < xsize; ++x) {
+        if ( std::isnan(result[x]))
+            result[x] = rUNDEF;
+    }
+}
+
+void LinearGridFilter::applyBox(const FilterLines &lines, double *result) const
+{
+    // column sums of the window, then a running sum over the columns: two operations per pixel whatever the size of the kernel
+    quint32 xsize = lines.xsize();
+    quint32 padded = xsize + _columns - 1;
+    std::vector<double> columns(padded, 0);
+    std::vector<quint32> undefs(padded, 0);
+    for(quint32 y=0; y < _rows; ++y) {
+        const double *line = lines.line(y);
+        for(quint32 x=0; x < padded; ++x) {
+            double v = line[x];
+            bool undef = isNumericalUndef(v);
+            columns[x] += undef ? 0 : v;
+            undefs[x] += undef;
+        }
+    }
+    double factor = _filterdef[0][0] * _gain;
+    double sum = 0;
+    quint32 undefCount = 0;
+    for(quint32 k=0; k < _columns; ++k) {
+        sum += columns[k];
+        undefCount += undefs[k];
+    }
+    for(quint32 x=0; x < xsize; ++x) {
+        result[x] = undefCount > 0 ? rUNDEF : sum * factor;
+        if ( x + _columns < padded) {
+            sum += columns[x + _columns] - columns[x];
+            undefCount += undefs[x + _columns] - undefs[x];
+        }
+    }
+}
+
 QSize LinearGridFilter::size() const
 {
     return QSize(_columns, _rows);
@@ -101,8 +301,8 @@ RankOrderGridFilter::RankOrderGridFilter(const QString &name)
 double RankOrderGridFilter::applyTo(const GridBlock &block)
 {
     std::vector<double> values = block.toVector();
-    std::sort(values.begin(), values.end());
     if ( _index  < values.size()) {
+        std::nth_element(values.begin(), values.begin() + _index, values.end());
         return values[_index];
     }
     return rUNDEF;
@@ -119,7 +319,180 @@ void RankOrderGridFilter::index(quint32 index)
     _index = index;
 }
 
+quint32 RankOrderGridFilter::index() const
+{
+    return _index;
+}
+
 QSize RankOrderGridFilter::size() const
 {
    return QSize(_columns, _rows);
 }
+
+//-------------------------------------------------------------------
+const quint32 RankOrderWindow::MAXBINS;
+const quint32 RankOrderWindow::FINEBINS;
+const quint32 RankOrderWindow::MINHISTOGRAMCELLS;
+
+RankOrderWindow::RankOrderWindow(const IRasterCoverage &raster, const QSize &filterSize, quint32 index, qint32 z) :
+    _lines(raster, filterSize, z),
+    _columns(filterSize.width()),
+    _rows(filterSize.height()),
+    _index(index)
+{
+    _buffer.resize(_columns * _rows);
+    SPNumericRange numrange = raster->datadef().range<NumericRange>();
+    quint32 cells = _columns * _rows;
+    if ( !numrange.isNull() && numrange->resolution() == 1 && cells >= MINHISTOGRAMCELLS && cells <= 0xFFFF) {
+        double bins = numrange->max() - numrange->min() + 1;
+        if ( bins > 0 && bins <= MAXBINS) {
+            _useHistograms = true;
+            _minValue = numrange->min();
+            _bins = bins;
+            _coarseBins = (_bins + FINEBINS - 1) / FINEBINS;
+            quint32 padded = _lines.xsize() + _columns - 1;
+            _columnHistograms.resize(padded * _coarseBins * FINEBINS);
+            _columnCoarse.resize(padded * _coarseBins);
+            _columnUndefs.resize(padded);
+        }
+    }
+}
+
+bool RankOrderWindow::usesHistograms() const
+{
+    return _useHistograms;
+}
+
+void RankOrderWindow::applyTo(qint32 y, double *result)
+{
+    if ( _useHistograms && _histogramLine != iUNDEF && y == _histogramLine + 1) {
+        // the top line of the current window leaves, the line below it enters
+        _useHistograms = addLine(_lines.line(0), -1);
+        _lines.moveTo(y);
+        _useHistograms = _useHistograms && addLine(_lines.line(_rows - 1), 1);
+    } else {
+        _lines.moveTo(y);
+        if ( _useHistograms)
+            rebuild();
+    }
+    _histogramLine = y;
+
+    if ( _useHistograms)
+        histogramLine(result);
+    else
+        selectLine(result);
+}
+
+void RankOrderWindow::rebuild()
+{
+    std::fill(_columnHistograms.begin(), _columnHistograms.end(), 0);
+    std::fill(_columnCoarse.begin(), _columnCoarse.end(), 0);
+    std::fill(_columnUndefs.begin(), _columnUndefs.end(), 0);
+    for(quint32 row = 0; row < _rows && _useHistograms; ++row)
+        _useHistograms = addLine(_lines.line(row), 1);
+}
+
+bool RankOrderWindow::addLine(const double *line, qint32 sign)
+{
+    // the range of the domain is only a promise; a value that does not fit a bin switches this window to selection for good
+    quint32 padded = _columnUndefs.size();
+    for(quint32 x = 0; x < padded; ++x) {
+        double v = line[x];
+        if ( isNumericalUndef(v)) {
+            _columnUndefs[x] += sign;
+            continue;
+        }
+        double bin = v - _minValue;
+        if ( bin < 0 || bin >= _bins || bin != std::floor(bin))
+            return false;
+        _columnHistograms[x * _coarseBins * FINEBINS + (quint32)bin] += sign;
+        _columnCoarse[x * _coarseBins + (quint32)bin / FINEBINS] += sign;
+    }
+    return true;
+}
+
+void RankOrderWindow::histogramLine(double *result)
+{
+    quint32 fineSize = _coarseBins * FINEBINS;
+    std::vector<quint32> coarse(_coarseBins, 0);
+    std::vector<quint32> fine(fineSize, 0);
+    // the output column for which each fine part of the window histogram is up to date; parts are only moved when they are needed
+    std::vector<qint32> fineAt(_coarseBins, iUNDEF);
+    quint32 undefs = 0;
+    for(quint32 x = 0; x < _columns; ++x) {
+        const quint16 *column = &_columnCoarse[x * _coarseBins];
+        for(quint32 bin = 0; bin < _coarseBins; ++bin)
+            coarse[bin] += column[bin];
+        undefs += _columnUndefs[x];
+    }
+
+    quint32 xsize = _lines.xsize();
+    quint32 cells = _columns * _rows;
+    for(quint32 x = 0; x < xsize; ++x) {
+        if ( _index >= cells)
+            result[x] = rUNDEF;
+        else if ( _index < undefs)
+            result[x] = rUNDEF;
+        else {
+            quint32 rank = _index - undefs;
+            quint32 part = 0;
+            quint32 count = coarse[0];
+            while(count <= rank)
+                count += coarse[++part];
+            rank -= count - coarse[part];
+
+            quint32 *segment = &fine[part * FINEBINS];
+            qint32 at = fineAt[part];
+            if ( at == iUNDEF || 2 * (x - (quint32)at) >= _columns) { // too far behind, summing the columns of the window is cheaper
+                std::fill(segment, segment + FINEBINS, 0);
+                for(quint32 column = x; column < x + _columns; ++column) {
+                    const quint16 *bins = &_columnHistograms[column * fineSize + part * FINEBINS];
+                    for(quint32 bin = 0; bin < FINEBINS; ++bin)
+                        segment[bin] += bins[bin];
+                }
+            } else {
+                for(quint32 column = at; column < x; ++column) {
+                    const quint16 *leaving = &_columnHistograms[column * fineSize + part * FINEBINS];
+                    const quint16 *entering = &_columnHistograms[(column + _columns) * fineSize + part * FINEBINS];
+                    for(quint32 bin = 0; bin < FINEBINS; ++bin)
+                        segment[bin] += entering[bin] - leaving[bin];
+                }
+            }
+            fineAt[part] = x;
+
+            quint32 bin = 0;
+            count = segment[0];
+            while(count <= rank)
+                count += segment[++bin];
+            result[x] = _minValue + part * FINEBINS + bin;
+        }
+        if ( x + 1 < xsize) {
+            const quint16 *leaving = &_columnCoarse[x * _coarseBins];
+            const quint16 *entering = &_columnCoarse[(x + _columns) * _coarseBins];
+            for(quint32 bin = 0; bin < _coarseBins; ++bin)
+                coarse[bin] += entering[bin] - leaving[bin];
+            undefs += _columnUndefs[x + _columns] - _columnUndefs[x];
+        }
+    }
+}
+
+void RankOrderWindow::selectLine(double *result)
+{
+    quint32 xsize = _lines.xsize();
+    std::vector<const double *> rows(_rows);
+    for(quint32 row = 0; row < _rows; ++row)
+        rows[row] = _lines.line(row);
+    for(quint32 x = 0; x < xsize; ++x) {
+        if ( _index >= _buffer.size()) {
+            result[x] = rUNDEF;
+            continue;
+        }
+        double *target = &_buffer[0];
+        for(quint32 row = 0; row < _rows; ++row) {
+            std::copy(rows[row] + x, rows[row] + x + _columns, target);
+            target += _columns;
+        }
+        std::nth_element(_buffer.begin(), _buffer.begin() + _index, _buffer.end());
+        result[x] = _buffer[_index];
+    }
+}
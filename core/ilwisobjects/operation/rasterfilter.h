@@ -5,6 +5,40 @@ namespace Ilwis {
 
 class GridBlock;
 
+/*!
+ * \brief The FilterLines class holds the input lines that the window of a filter covers for one output line
+ *
+ * Every input line is read once into a buffer that is padded on both sides with the border value (the same clamping GridBlock::operator() does
+ * at the edges of the raster); moving on to the next output line only reads the one line that enters the window. Filters that work
+ * on whole lines take their taps straight from these buffers instead of going through the grid for every tap.
+ */
+class KERNELSHARED_EXPORT FilterLines {
+public:
+    FilterLines(const IRasterCoverage& raster, const QSize& filterSize, qint32 z=0);
+
+    void moveTo(qint32 y);
+    /*!
+     * \brief line gives a line of the window, row 0 is the top line
+     * \return pointer to the cell at column -(filter columns / 2); the line is xsize() + filter columns - 1 cells long
+     */
+    const double *line(quint32 row) const;
+    quint32 xsize() const;
+
+private:
+    void load(qint32 y, std::vector<double>& buffer);
+    quint32 slot(qint32 y) const;
+
+    IRasterCoverage _raster;
+    qint32 _dx;
+    qint32 _dy;
+    qint32 _z;
+    quint32 _xsize;
+    qint32 _ysize;
+    qint32 _current = iUNDEF;
+    std::vector<std::vector<double>> _buffers;
+    std::vector<qint32> _loaded;
+};
+
 class KERNELSHARED_EXPORT RasterFilter
 {
 public:
@@ -20,18 +54,38 @@ protected:
 
 class KERNELSHARED_EXPORT LinearGridFilter : public RasterFilter{
 public:
+    enum KernelType{ktGENERAL, ktSEPARABLE, ktBOX};
+
     LinearGridFilter(const QString& name);
 
     double applyTo(const Ilwis::GridBlock &block);
+    /*!
+     * \brief applyTo filters a complete output line
+     *
+     * Separable kernels (an outer product of a column and a row) are applied as a vertical and a horizontal 1-D pass, kernels
+     * with one weight everywhere (box/average) as vertical sums with a running sum over the columns. A window that contains an
+     * undefined value gives an undefined result.
+     * \param lines the window around the output line
+     * \param result receives lines.xsize() values
+     */
+    void applyTo(const FilterLines& lines, double *result) const;
     QSize size() const;
+    KernelType kernelType() const;
 
 private:
     quint32 _columns;
     quint32 _rows;
     double _gain;
     std::vector<std::vector<double>> _filterdef;
+    KernelType _kernelType = ktGENERAL;
+    std::vector<double> _columnWeights; // vertical pass of a separable kernel
+    std::vector<double> _rowWeights; // horizontal pass of a separable kernel
 
     bool definition(const QString& name);
+    void analyze();
+    void applyGeneral(const FilterLines& lines, double *result) const;
+    void applySeparable(const FilterLines& lines, double *result) const;
+    void applyBox(const FilterLines& lines, double *result) const;
 
 
 };
@@ -43,6 +97,7 @@ public:
     double applyTo(const Ilwis::GridBlock &block);
     void colrow(quint32 col, quint32 row);
     void index(quint32 index);
+    quint32 index() const;
     QSize size() const;
 
 private:
@@ -54,6 +109,50 @@ private:
 
 
 };
+
+/*!
+ * \brief The RankOrderWindow class computes a rank order filter line by line over the lines of one band
+ *
+ * Larger windows (MINHISTOGRAMCELLS cells or more) over rasters with a small integer range (at most 256 values, e.g. 8-bit imagery)
+ * are done with sliding histograms (Perreault & H&eacute;bert): every column keeps a histogram of its part of the window that is updated
+ * with one value in and one out per line, and the window histogram moves along the line by adding the column that enters and removing
+ * the one that leaves. The histograms are two-level, 16 coarse bins of 16 fine bins each; the coarse window histogram is moved for
+ * every pixel, a fine part only when the rank falls in it, so a pixel costs a few dozen bin operations whatever the window size.
+ * Smaller windows and other data copy each window into a reused buffer and select the rank with nth_element.
+ * Undefined values rank below everything, as they would in a sort of the window. A window is meant for one thread and is used for
+ * consecutive lines; other lines work too but rebuild the column histograms.
+ */
+class KERNELSHARED_EXPORT RankOrderWindow {
+public:
+    RankOrderWindow(const IRasterCoverage& raster, const QSize& filterSize, quint32 index, qint32 z=0);
+
+    void applyTo(qint32 y, double *result);
+    bool usesHistograms() const;
+
+private:
+    static const quint32 MAXBINS = 256;
+    static const quint32 FINEBINS = 16; // fine bins per coarse bin
+    static const quint32 MINHISTOGRAMCELLS = 49; // below this a selection over the window is cheaper than the histograms
+
+    bool addLine(const double *line, qint32 sign);
+    void rebuild();
+    void histogramLine(double *result);
+    void selectLine(double *result);
+
+    FilterLines _lines;
+    quint32 _columns;
+    quint32 _rows;
+    quint32 _index;
+    bool _useHistograms = false;
+    double _minValue = 0;
+    quint32 _bins = 0;
+    quint32 _coarseBins = 0;
+    std::vector<quint16> _columnHistograms; // fine bins (_coarseBins * FINEBINS) per padded column
+    std::vector<quint16> _columnCoarse; // coarse bins per padded column
+    std::vector<quint16> _columnUndefs;
+    qint32 _histogramLine = iUNDEF; // output line of the window the column histograms hold
+    std::vector<double> _buffer;
+};
 }
 
 #endif // RASTERFILTER_H
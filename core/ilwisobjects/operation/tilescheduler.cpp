@@ -0,0 +1,133 @@
+#include <thread>
+#include <QThread>
+#include "kernel.h"
+#include "ilwisdata.h"
+#include "raster.h"
+#include "commandhandler.h"
+#include "tilescheduler.h"
+
+using namespace Ilwis;
+
+TileScheduler *Ilwis::tilescheduler()
+{
+    static TileScheduler *scheduler = new TileScheduler(); // never deleted, the workers live as long as the process
+    return scheduler;
+}
+
+TileScheduler::TileScheduler()
+{
+    // the thread that starts a job always works on it, so the pool needs one thread less than there are cores
+    _workers = std::max(1, QThread::idealThreadCount() - 1);
+    for(int i = 0; i < _workers; ++i) {
+        std::thread worker([this]{ work(); });
+        worker.detach();
+    }
+}
+
+int TileScheduler::workers() const
+{
+    return _workers;
+}
+
+bool TileScheduler::execute(const std::vector<BoundingBox> &tiles, int threads, const BoxedAsyncFunc &func, ExecutionContext *ctx)
+{
+    if ( tiles.size() == 0)
+        return true;
+
+    Job job;
+    job._tiles = &tiles;
+    job._func = &func;
+    job._ctx = ctx;
+    job._participants = std::max(1, std::min(std::min(threads, _workers + 1), (int)tiles.size()));
+    job._queues.reset(new TileQueue[job._participants]);
+    for(quint32 i = 0; i < tiles.size(); ++i) {
+        int slot = (quint64)i * job._participants / tiles.size();
+        job._queues[slot]._tiles.push_back(i);
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        job._nextSlot = 1; // slot 0 belongs to the calling thread
+        job._active = 1;
+        if ( job._participants > 1) {
+            _jobs.push_back(&job);
+            _wakeup.notify_all();
+        }
+    }
+
+    runTiles(&job, 0);
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _jobs.remove(&job); // nobody may join anymore, the ones that did are waited for
+        --job._active;
+        job._left.wait(lock, [&job]{ return job._active == 0; });
+    }
+    if ( job._error)
+        std::rethrow_exception(job._error);
+
+    return !job._failed && !(ctx && ctx->_cancelled);
+}
+
+void TileScheduler::work()
+{
+    while(true) {
+        Job *job = 0;
+        int slot = 0;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wakeup.wait(lock, [this]{ return _jobs.size() > 0; });
+            job = _jobs.front();
+            slot = job->_nextSlot++;
+            ++job->_active;
+            if ( job->_nextSlot >= job->_participants)
+                _jobs.pop_front();
+        }
+
+        runTiles(job, slot);
+
+        // notify while holding the lock; once it is released the owner may return and destroy the job
+        std::lock_guard<std::mutex> lock(_mutex);
+        --job->_active;
+        job->_left.notify_all();
+    }
+}
+
+void TileScheduler::runTiles(Job *job, int slot)
+{
+    quint32 tile;
+    while(!job->_failed && !(job->_ctx && job->_ctx->_cancelled) && takeTile(job, slot, tile)) {
+        try {
+            if (!(*job->_func)((*job->_tiles)[tile]))
+                job->_failed = true;
+        } catch(...) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if ( !job->_error)
+                job->_error = std::current_exception();
+            job->_failed = true;
+        }
+    }
+}
+
+bool TileScheduler::takeTile(Job *job, int slot, quint32 &tile)
+{
+    TileQueue& own = job->_queues[slot];
+    {
+        std::lock_guard<std::mutex> lock(own._mutex);
+        if ( own._tiles.size() > 0) {
+            tile = own._tiles.front();
+            own._tiles.pop_front();
+            return true;
+        }
+    }
+    // steal from the far end of another range, that keeps the owner walking through its own blocks in order
+    for(int i = 1; i < job->_participants; ++i) {
+        TileQueue& victim = job->_queues[(slot + i) % job->_participants];
+        std::lock_guard<std::mutex> lock(victim._mutex);
+        if ( victim._tiles.size() > 0) {
+            tile = victim._tiles.back();
+            victim._tiles.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,66 @@
+#ifndef TILESCHEDULER_H
+#define TILESCHEDULER_H
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <list>
+
+namespace Ilwis {
+
+struct ExecutionContext;
+typedef  std::function<bool(const BoundingBox&)> BoxedAsyncFunc;
+
+/*!
+ * \brief The TileScheduler class runs a function over a set of tiles with a persistent pool of worker threads
+ *
+ * Each participating thread starts with a contiguous range of the tiles (so it walks its part of the raster in block order) and when
+ * it runs out of work it steals tiles from the back of the range of another thread. The calling thread always takes part in its own job,
+ * so jobs started from within a worker (nested operations) can not starve. A job stops early (cooperatively, between tiles) when a tile
+ * function fails, throws or when ExecutionContext::_cancelled is set.
+ */
+class KERNELSHARED_EXPORT TileScheduler
+{
+public:
+    friend KERNELSHARED_EXPORT TileScheduler* tilescheduler();
+
+    bool execute(const std::vector<BoundingBox>& tiles, int threads, const BoxedAsyncFunc& func, ExecutionContext *ctx);
+    int workers() const;
+
+private:
+    struct TileQueue {
+        std::mutex _mutex;
+        std::deque<quint32> _tiles;
+    };
+
+    struct Job {
+        const std::vector<BoundingBox> *_tiles = 0;
+        const BoxedAsyncFunc *_func = 0;
+        ExecutionContext *_ctx = 0;
+        std::unique_ptr<TileQueue[]> _queues;
+        int _participants = 0;
+        int _nextSlot = 0;
+        int _active = 0;
+        std::atomic<bool> _failed{false};
+        std::exception_ptr _error;
+        std::condition_variable _left;
+    };
+
+    TileScheduler();
+    void work();
+    void runTiles(Job *job, int slot);
+    bool takeTile(Job *job, int slot, quint32& tile);
+
+    std::mutex _mutex;
+    std::condition_variable _wakeup;
+    std::list<Job *> _jobs;
+    int _workers = 0;
+};
+
+KERNELSHARED_EXPORT TileScheduler* tilescheduler();
+}
+
+#endif // TILESCHEDULER_H
@@ -161,6 +161,11 @@ void BaseTable::copyTo(IlwisObject *obj)
         btable->column(colIndex, colvalues);
     }
     btable->_rows = _rows;
+
+    // the copy gets the same indexes; they are built when the copy is first searched
+    std::lock_guard<std::mutex> lock(_indexMutex);
+    for(const auto& index : _indexes)
+        btable->_indexes.emplace(index.first, ColumnIndex(index.second.kind()));
 }
 
 quint32 BaseTable::columnIndex(const QString &columnname) const
@@ -299,6 +304,87 @@ void BaseTable::removeRecord(quint32 rec)
     --_rows;
 }
 
+bool BaseTable::addIndex(const QString &columnname)
+{
+    quint32 index = columnIndex(columnname);
+    if ( index == iUNDEF) {
+        ERROR2(ERR_NOT_FOUND2, TR("column ") + columnname, name());
+        return false;
+    }
+    IDomain dom = columndefinition(index).datadef().domain<>();
+    if ( !dom.isValid()) {
+        ERROR2(ERR_NO_INITIALIZED_2, TR("domain"), columnname);
+        return false;
+    }
+    ColumnIndex::Kind kind;
+    if ( hasType(dom->ilwisType(), itITEMDOMAIN))
+        kind = ColumnIndex::ikHASH;
+    else if ( hasType(dom->valueType(), itNUMBER))
+        kind = ColumnIndex::ikSORTED;
+    else {
+        ERROR2(ERR_OPERATION_NOTSUPPORTED2, TR("index"), columnname);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(_indexMutex);
+    if ( _indexes.find(index) == _indexes.end())
+        _indexes.emplace(index, ColumnIndex(kind));
+    return true;
+}
+
+void BaseTable::removeIndex(const QString &columnname)
+{
+    std::lock_guard<std::mutex> lock(_indexMutex);
+    _indexes.erase(columnIndex(columnname));
+}
+
+bool BaseTable::hasIndex(quint32 columnIndex) const
+{
+    std::lock_guard<std::mutex> lock(_indexMutex);
+    return _indexes.find(columnIndex) != _indexes.end();
+}
+
+bool BaseTable::indexLookup(quint32 columnIndex, LogicalOperator condition, double key, std::vector<quint32> &records) const
+{
+    std::lock_guard<std::mutex> lock(_indexMutex);
+    auto iter = _indexes.find(columnIndex);
+    if ( iter == _indexes.end())
+        return false;
+
+    // loading the data changes the columns, so it must happen before the version is taken
+    if (!const_cast<BaseTable *>(this)->initLoad())
+        return false;
+    ColumnIndex& index = (*iter).second;
+    quint64 version = 0;
+    bool tracked = columnVersion(columnIndex, version);
+    if ( !tracked || !index.isCurrent(version)) {
+        if ( index.kind() == ColumnIndex::ikHASH) {
+            std::vector<quint32> buffer;
+            ColumnSpan<quint32> raws = integerColumn(columnIndex, buffer);
+            index.build(raws.begin(), raws.size(), version);
+        } else if ( hasType(const_cast<BaseTable *>(this)->columndefinitionRef(columnIndex).datadef().domain<>()->valueType(), itDATETIME)) {
+            // times are compared by their double value, as the selections do
+            std::vector<QVariant> data = column(columnIndex);
+            std::vector<double> values(data.size());
+            for(quint32 i = 0; i < data.size(); ++i)
+                values[i] = (double)data[i].value<Ilwis::Time>();
+            index.build(values.data(), values.size(), version);
+        } else {
+            std::vector<double> buffer;
+            ColumnSpan<double> values = realColumn(columnIndex, buffer);
+            index.build(values.begin(), values.size(), version);
+        }
+    }
+    bool found = index.find(condition, key, records);
+    if ( !tracked) // nothing to check it against next time, so it is not kept
+        index = ColumnIndex(index.kind());
+    return found;
+}
+
+bool BaseTable::columnVersion(quint32, quint64 &) const
+{
+    return false;
+}
+
 
 
 
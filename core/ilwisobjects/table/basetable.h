@@ -3,10 +3,13 @@
 
 #include <QSqlDatabase>
 #include <unordered_map>
+#include <map>
+#include <mutex>
 #include "boost/container/flat_map.hpp"
 #include "attributedefinition.h"
 #include "selectabletable.h"
 #include "table.h"
+#include "columnindex.h"
 
 #include "kernel_global.h"
 
@@ -94,6 +97,28 @@ public:
     bool isDataLoaded() const;
     void initValuesColumn(const QString& colname);
 
+    /*!
+     * \brief addIndex puts a secondary index on a column: a hash index on an item column, a sorted index on a numeric or time column
+     *
+     * The index is built at the first lookup and rebuilt at the first lookup after the column has changed, so writes to the column
+     * (setCell, column(), records) do not pay for it. Selections (see TableSelector) use the index when there is one.
+     * \param columnname the column to index
+     * \return false if the column does not exist or its values can not be indexed (e.g. text)
+     */
+    bool addIndex(const QString& columnname);
+    void removeIndex(const QString& columnname);
+    bool hasIndex(quint32 columnIndex) const;
+    /*!
+     * \brief indexLookup adds the records of which the value in the indexed column satisfies the condition to records
+     *
+     * \param columnIndex an indexed column
+     * \param condition loEQ for all indexes; loLESS, loLESSEQ, loGREATER and loGREATEREQ for numeric and time columns
+     * \param key the raw of an item, a number or the double value of a time
+     * \param records the records found, in no particular order
+     * \return false if there is no index on the column or it can not answer the condition; the column must then be scanned
+     */
+    bool indexLookup(quint32 columnIndex, LogicalOperator condition, double key, std::vector<quint32>& records) const;
+
 protected:
      AttributeDefinition _attributeDefinition;
 
@@ -105,10 +130,17 @@ protected:
     QVariant checkInput(const QVariant &inputVar, quint32 columnIndex);
     void initRecord(std::vector<QVariant>& values) const;
     void removeRecord(quint32 rec);
+    /*!
+     * \brief columnVersion gives a number that changes with every change of the column
+     * \return false if the table does not track changes; an index on the column is then rebuilt for every lookup
+     */
+    virtual bool columnVersion(quint32 columnIndex, quint64& version) const;
 private:
     quint32 _rows;
     quint32 _columns;
     bool _dataloaded;
+    mutable std::map<quint32, ColumnIndex> _indexes;
+    mutable std::mutex _indexMutex;
 };
 }
 
@@ -0,0 +1,99 @@
+#include "kernel.h"
+#include "columnindex.h"
+
+using namespace Ilwis;
+
+ColumnIndex::ColumnIndex(Kind kind) : _kind(kind)
+{
+}
+
+ColumnIndex::Kind ColumnIndex::kind() const
+{
+    return _kind;
+}
+
+bool ColumnIndex::isCurrent(quint64 version) const
+{
+    return _built && version == _version;
+}
+
+void ColumnIndex::build(const quint32 *keys, quint32 count, quint64 version)
+{
+    _buckets.clear();
+    _keys = std::vector<double>();
+    // counting pass, then every record is placed in the group of its key
+    for(quint32 rec = 0; rec < count; ++rec)
+        ++_buckets[keys[rec]].second;
+    quint32 start = 0;
+    for(auto& bucket : _buckets) {
+        quint32 size = bucket.second.second;
+        bucket.second = {start, start};
+        start += size;
+    }
+    _records.resize(count);
+    for(quint32 rec = 0; rec < count; ++rec)
+        _records[_buckets[keys[rec]].second++] = rec;
+
+    _version = version;
+    _built = true;
+}
+
+void ColumnIndex::build(const double *keys, quint32 count, quint64 version)
+{
+    _buckets.clear();
+    _records.clear();
+    for(quint32 rec = 0; rec < count; ++rec)
+        if ( !isNumericalUndef(keys[rec]))
+            _records.push_back(rec);
+    std::sort(_records.begin(), _records.end(), [keys](quint32 rec1, quint32 rec2) { return keys[rec1] < keys[rec2]; });
+    _keys.resize(_records.size());
+    for(quint32 i = 0; i < _records.size(); ++i)
+        _keys[i] = keys[_records[i]];
+
+    _version = version;
+    _built = true;
+}
+
+bool ColumnIndex::find(LogicalOperator condition, double key, std::vector<quint32> &records) const
+{
+    if ( !_built)
+        return false;
+
+    if ( _kind == ikHASH) {
+        if ( condition != loEQ)
+            return false;
+        if ( key < 0 || key > std::numeric_limits<quint32>::max() || key != (quint32)key) // not a raw, so no record has it
+            return true;
+        auto iter = _buckets.find((quint32)key);
+        if ( iter != _buckets.end())
+            records.insert(records.end(), _records.begin() + (*iter).second.first, _records.begin() + (*iter).second.second);
+        return true;
+    }
+
+    if ( key == rUNDEF) // undefined values are not in the index
+        return false;
+    auto first = _keys.begin();
+    auto last = _keys.end();
+    switch(condition){
+    case loEQ:
+        first = std::lower_bound(_keys.begin(), _keys.end(), key);
+        last = std::upper_bound(first, _keys.end(), key);
+        break;
+    case loLESS:
+        last = std::lower_bound(_keys.begin(), _keys.end(), key);
+        break;
+    case loLESSEQ:
+        last = std::upper_bound(_keys.begin(), _keys.end(), key);
+        break;
+    case loGREATER:
+        first = std::upper_bound(_keys.begin(), _keys.end(), key);
+        break;
+    case loGREATEREQ:
+        first = std::lower_bound(_keys.begin(), _keys.end(), key);
+        break;
+    default:
+        return false;
+    }
+    records.insert(records.end(), _records.begin() + (first - _keys.begin()), _records.begin() + (last - _keys.begin()));
+    return true;
+}
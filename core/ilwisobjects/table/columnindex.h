@@ -0,0 +1,53 @@
+#ifndef COLUMNINDEX_H
+#define COLUMNINDEX_H
+
+#include <unordered_map>
+#include "kernel_global.h"
+
+namespace Ilwis {
+
+/*!
+ * \brief The ColumnIndex class is a secondary index on one column of a table
+ *
+ * A hash index maps the raws of an item (or identifier) column to the records that have them and answers equality lookups.
+ * A sorted index keeps the defined values of a numeric or time column in order and answers equality and range lookups; undefined
+ * values are not in it. The index is built from a snapshot of the column; it remembers the version of the column it was built from
+ * so the table can rebuild it once the column has changed.
+ */
+class KERNELSHARED_EXPORT ColumnIndex
+{
+public:
+    enum Kind{ ikHASH, ikSORTED };
+
+    ColumnIndex(Kind kind=ikSORTED);
+
+    Kind kind() const;
+    /*!
+     * \brief isCurrent tells if the index was built from the given version of the column
+     */
+    bool isCurrent(quint64 version) const;
+
+    void build(const quint32 *keys, quint32 count, quint64 version);
+    void build(const double *keys, quint32 count, quint64 version);
+
+    /*!
+     * \brief find adds the records of which the key satisfies the condition to records, in no particular order
+     *
+     * \param condition loEQ for both kinds, loLESS, loLESSEQ, loGREATER and loGREATEREQ for a sorted index
+     * \param key a raw for a hash index, a value for a sorted index
+     * \return false if the index can not answer the condition (e.g. loNEQ, or a range on a hash index); records is then untouched
+     */
+    bool find(LogicalOperator condition, double key, std::vector<quint32>& records) const;
+
+private:
+    Kind _kind;
+    bool _built = false;
+    quint64 _version = 0;
+    // hash: the records grouped per key, _buckets gives the begin and end of a group; sorted: the records in the order of _keys
+    std::unordered_map<quint32, std::pair<quint32, quint32>> _buckets;
+    std::vector<double> _keys;
+    std::vector<quint32> _records;
+};
+}
+
+#endif // COLUMNINDEX_H
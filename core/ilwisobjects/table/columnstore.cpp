@@ -0,0 +1,293 @@
+#include "kernel.h"
+#include "ilwisdata.h"
+#include "domain.h"
+#include "datadefinition.h"
+#include "columndefinition.h"
+#include "columnstore.h"
+
+using namespace Ilwis;
+
+TableColumn::TableColumn(StorageType type) : _type(type)
+{
+}
+
+TableColumn::StorageType TableColumn::storageType(const ColumnDefinition &coldef)
+{
+    IDomain dom = coldef.datadef().domain<>();
+    if ( !dom.isValid())
+        return stVARIANT;
+    IlwisTypes domtype = dom->ilwisType();
+    if ( domtype == itNUMERICDOMAIN)
+        return hasType(dom->valueType(), itDATETIME) ? stVARIANT : stREAL;
+    if ( domtype == itITEMDOMAIN)
+        return stINTEGER;
+    if ( domtype == itTEXTDOMAIN)
+        return stSTRING;
+    return stVARIANT;
+}
+
+TableColumn::StorageType TableColumn::storageType() const
+{
+    return _type;
+}
+
+quint32 TableColumn::size() const
+{
+    return _null.size();
+}
+
+void TableColumn::resize(quint32 rows)
+{
+    switch(_type){
+    case stREAL:
+        _reals.resize(rows, rUNDEF); break;
+    case stINTEGER:
+        _integers.resize(rows, iUNDEF); break;
+    case stSTRING:
+        _strings.resize(rows); break;
+    case stVARIANT:
+        _variants.resize(rows); break;
+    }
+    if ( rows != _null.size())
+        ++_version;
+    _null.resize(rows, true);
+}
+
+void TableColumn::erase(quint32 row)
+{
+    if ( row >= size())
+        return;
+    switch(_type){
+    case stREAL:
+        _reals.erase(_reals.begin() + row); break;
+    case stINTEGER:
+        _integers.erase(_integers.begin() + row); break;
+    case stSTRING:
+        _strings.erase(_strings.begin() + row); break;
+    case stVARIANT:
+        _variants.erase(_variants.begin() + row); break;
+    }
+    _null.erase(_null.begin() + row);
+    ++_version;
+}
+
+bool TableColumn::isNull(quint32 row) const
+{
+    return row >= size() || _null[row];
+}
+
+QVariant TableColumn::value(quint32 row) const
+{
+    if ( isNull(row))
+        return QVariant();
+    switch(_type){
+    case stREAL:
+        return _reals[row];
+    case stINTEGER:
+        if ( _integers[row] == (quint32)iUNDEF)
+            return QVariant((int)iUNDEF);
+        return _integers[row];
+    case stSTRING:
+        return _strings[row];
+    case stVARIANT:
+        return _variants[row];
+    }
+    return QVariant();
+}
+
+void TableColumn::value(quint32 row, const QVariant &var)
+{
+    if ( row >= size())
+        return;
+    if (!store(row, var)) {
+        toVariants();
+        store(row, var);
+    }
+    ++_version;
+}
+
+const double *TableColumn::reals() const
+{
+    return _type == stREAL ? _reals.data() : 0;
+}
+
+const quint32 *TableColumn::integers() const
+{
+    return _type == stINTEGER ? _integers.data() : 0;
+}
+
+void TableColumn::reals(quint32 row, const double *values, quint32 count)
+{
+    if ( _type != stREAL || row + count > size())
+        return;
+    std::copy(values, values + count, _reals.begin() + row);
+    std::fill(_null.begin() + row, _null.begin() + row + count, false);
+    ++_version;
+}
+
+quint64 TableColumn::version() const
+{
+    return _version;
+}
+
+bool TableColumn::store(quint32 row, const QVariant &var)
+{
+    if ( !var.isValid()) {
+        switch(_type){
+        case stREAL:
+            _reals[row] = rUNDEF; break;
+        case stINTEGER:
+            _integers[row] = iUNDEF; break;
+        case stSTRING:
+            _strings[row] = QString(); break;
+        case stVARIANT:
+            _variants[row] = QVariant(); break;
+        }
+        _null[row] = true;
+        return true;
+    }
+
+    int vtype = var.type();
+    bool isNumber = vtype == QVariant::Int || vtype == QVariant::UInt || vtype == QVariant::LongLong || vtype == QVariant::ULongLong ||
+            vtype == QVariant::Double || vtype == QMetaType::Float;
+    bool ok = true;
+    switch(_type){
+    case stREAL:{
+        if ( !isNumber && vtype != QVariant::String)
+            return false;
+        double v = var.toDouble(&ok);
+        if (!ok)
+            return false;
+        _reals[row] = v;
+        break;
+    }
+    case stINTEGER:{
+        if ( !isNumber && vtype != QVariant::String)
+            return false;
+        double v = var.toDouble(&ok);
+        if ( !ok)
+            return false;
+        if ( v == rUNDEF)
+            v = iUNDEF;
+        if ( v < 0 || v > std::numeric_limits<quint32>::max() || v != (quint32)v)
+            return false;
+        _integers[row] = (quint32)v;
+        break;
+    }
+    case stSTRING:
+        if ( vtype != QVariant::String)
+            return false;
+        _strings[row] = var.toString();
+        break;
+    case stVARIANT:
+        _variants[row] = var;
+        break;
+    }
+    _null[row] = false;
+    return true;
+}
+
+void TableColumn::toVariants()
+{
+    if ( _type == stVARIANT)
+        return;
+    std::vector<QVariant> variants(size());
+    for(quint32 row = 0; row < variants.size(); ++row)
+        variants[row] = value(row);
+    _reals = std::vector<double>();
+    _integers = std::vector<quint32>();
+    _strings = std::vector<QString>();
+    _variants.swap(variants);
+    _type = stVARIANT;
+}
+
+//----------------------------------------------------------------------
+ColumnStore::ColumnStore()
+{
+}
+
+quint32 ColumnStore::recordCount() const
+{
+    return _rows;
+}
+
+void ColumnStore::recordCount(quint32 rows)
+{
+    for(TableColumn& column : _columns)
+        column.resize(rows);
+    _changed.resize(rows, false);
+    _rows = rows;
+}
+
+void ColumnStore::removeRecord(quint32 row)
+{
+    if ( row >= _rows)
+        return;
+    for(TableColumn& column : _columns)
+        column.erase(row);
+    _changed.erase(_changed.begin() + row);
+    --_rows;
+}
+
+quint32 ColumnStore::columnCount() const
+{
+    return _columns.size();
+}
+
+void ColumnStore::addColumn(TableColumn::StorageType type)
+{
+    _columns.push_back(TableColumn(type));
+    _columns.back().resize(_rows);
+}
+
+QVariant ColumnStore::cell(quint32 column, quint32 row) const
+{
+    if ( column < _columns.size())
+        return _columns[column].value(row);
+    return QVariant();
+}
+
+void ColumnStore::cell(quint32 column, quint32 row, const QVariant &var)
+{
+    if ( column < _columns.size() && row < _rows){
+        _columns[column].value(row, var);
+        _changed[row] = true;
+    }
+}
+
+void ColumnStore::reals(quint32 column, quint32 row, const double *values, quint32 count)
+{
+    if ( column < _columns.size() && row + count <= _rows){
+        _columns[column].reals(row, values, count);
+        std::fill(_changed.begin() + row, _changed.begin() + row + count, true);
+    }
+}
+
+std::vector<QVariant> ColumnStore::record(quint32 row) const
+{
+    std::vector<QVariant> values(_columns.size());
+    for(quint32 col = 0; col < _columns.size(); ++col)
+        values[col] = _columns[col].value(row);
+    return values;
+}
+
+bool ColumnStore::isChanged(quint32 row) const
+{
+    return row < _rows && _changed[row];
+}
+
+void ColumnStore::changed(quint32 row, bool yesno)
+{
+    if ( row < _rows)
+        _changed[row] = yesno;
+}
+
+void ColumnStore::changed(bool yesno)
+{
+    std::fill(_changed.begin(), _changed.end(), yesno);
+}
+
+const TableColumn &ColumnStore::column(quint32 index) const
+{
+    return _columns.at(index);
+}
@@ -0,0 +1,98 @@
+#ifndef COLUMNSTORE_H
+#define COLUMNSTORE_H
+
+#include "kernel_global.h"
+
+namespace Ilwis {
+
+class ColumnDefinition;
+
+/*!
+ * \brief The TableColumn class holds the cells of one table column in one contiguous typed array
+ *
+ * The type of the array follows from the domain of the column: numeric domains store doubles, item domains the raw values of the items
+ * and text domains strings. Cells that never got a value are marked in a null bitmap and read back as an invalid QVariant.
+ * Everything else (e.g. times, coordinates, colors) and values that can not be represented in the typed array (a text in a numeric column)
+ * are stored as QVariants; a typed column that gets such a value converts itself once to variant storage.
+ */
+class KERNELSHARED_EXPORT TableColumn
+{
+public:
+    enum StorageType{ stREAL, stINTEGER, stSTRING, stVARIANT };
+
+    TableColumn(StorageType type=stVARIANT);
+
+    static StorageType storageType(const ColumnDefinition& coldef);
+    StorageType storageType() const;
+
+    quint32 size() const;
+    void resize(quint32 rows);
+    void erase(quint32 row);
+
+    bool isNull(quint32 row) const;
+    QVariant value(quint32 row) const;
+    void value(quint32 row, const QVariant& var);
+
+    /*!
+     * \brief reals gives the cells of a stREAL column, 0 for other storage types; null cells contain rUNDEF
+     */
+    const double *reals() const;
+    /*!
+     * \brief integers gives the cells of a stINTEGER column, 0 for other storage types; null cells contain iUNDEF
+     */
+    const quint32 *integers() const;
+    /*!
+     * \brief reals sets count cells of a stREAL column from row onwards
+     */
+    void reals(quint32 row, const double *values, quint32 count);
+    /*!
+     * \brief version counts the changes of the column; every write or resize raises it, so anything derived from the cells (e.g. a ColumnIndex) can tell it is outdated
+     */
+    quint64 version() const;
+
+private:
+    bool store(quint32 row, const QVariant& var);
+    void toVariants();
+
+    StorageType _type;
+    std::vector<double> _reals;
+    std::vector<quint32> _integers;
+    std::vector<QString> _strings;
+    std::vector<QVariant> _variants;
+    std::vector<bool> _null;
+    quint64 _version = 0;
+};
+
+/*!
+ * \brief The ColumnStore class is the columnar data of a table: one TableColumn per column and a changed flag per record
+ */
+class KERNELSHARED_EXPORT ColumnStore
+{
+public:
+    ColumnStore();
+
+    quint32 recordCount() const;
+    void recordCount(quint32 rows);
+    void removeRecord(quint32 row);
+    quint32 columnCount() const;
+    void addColumn(TableColumn::StorageType type);
+
+    QVariant cell(quint32 column, quint32 row) const;
+    void cell(quint32 column, quint32 row, const QVariant& var);
+    void reals(quint32 column, quint32 row, const double *values, quint32 count);
+    std::vector<QVariant> record(quint32 row) const;
+
+    bool isChanged(quint32 row) const;
+    void changed(quint32 row, bool yesno);
+    void changed(bool yesno);
+
+    const TableColumn& column(quint32 index) const;
+
+private:
+    std::vector<TableColumn> _columns;
+    std::vector<bool> _changed;
+    quint32 _rows = 0;
+};
+}
+
+#endif // COLUMNSTORE_H
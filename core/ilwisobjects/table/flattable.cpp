@@ -11,9 +11,21 @@
 #include "flattable.h"
 #include "tablemerger.h"
 #include "itemrange.h"
+#include <QThreadStorage>
 
 using namespace Ilwis;
 
+namespace {
+struct RecordViews {
+    std::vector<Record> _views;
+    quint32 _next = 0;
+};
+// the views handed out by FlatTable::view(), per thread and shared by all tables
+QThreadStorage<RecordViews *> recordViews;
+}
+
+const quint32 FlatTable::RECORDVIEWS;
+
 FlatTable::FlatTable()
 {
 }
@@ -24,7 +36,6 @@ FlatTable::FlatTable(const Resource& resource) : BaseTable(resource){
 
 FlatTable::~FlatTable()
 {
-    _datagrid.clear();
 }
 
 bool FlatTable::createTable()
@@ -32,9 +43,8 @@ bool FlatTable::createTable()
     if(!BaseTable::createTable()) {
         return false;
     }
-    for(unsigned int i=0; i < recordCount(); ++i) {
-        _datagrid.push_back(std::vector<QVariant>(_attributeDefinition.definitionCount()));
-    }
+    ensureColumns();
+    _datagrid.recordCount(recordCount());
     return true;
 }
 
@@ -47,14 +57,18 @@ Record& FlatTable::newRecord()
     std::vector<QVariant> values;
     initRecord(values);
     record(NEW_RECORD, values);
+    if ( _datagrid.recordCount() == 0) {
+        throw ErrorObject(QString(TR("could not add a record to %1")).arg(name()));
+    }
 
-    return _datagrid.back();
+    return view(_datagrid.recordCount() - 1);
 }
 
 void FlatTable::removeRecord(quint32 rec)
 {
-    if ( rec < recordCount()){
-        _datagrid.erase(_datagrid.begin() + rec);
+    if ( rec < _datagrid.recordCount()){
+        _datagrid.removeRecord(rec);
+        recordCount(_datagrid.recordCount());
     }
 }
 
@@ -74,11 +88,8 @@ bool FlatTable::addColumn(const QString &name, const IDomain &domain,const bool
     if(!ok) {
         return false;
     }
+    ensureColumns();
     if ( isDataLoaded()){
-        for(Record& row : _datagrid) {
-            row.addColumn();
-            row.changed(true);
-        }
         initValuesColumn(name);
     }
     return true;
@@ -91,11 +102,8 @@ bool FlatTable::addColumn(const ColumnDefinition &def)
     if(!ok) {
         return false;
     }
+    ensureColumns();
     if (  isDataLoaded()) {
-        for(Record& row : _datagrid) {
-            row.addColumn();
-            row.changed(true);
-        }
         initValuesColumn(def.name());
     }
     return true;
@@ -110,11 +118,17 @@ std::vector<QVariant> FlatTable::column(quint32 index, quint32 start, quint32 st
         return std::vector<QVariant>();
     }
 
-    stop = std::min(stop, recordCount());
-    start = std::max((quint32)0, start);
+    stop = std::min(stop, _datagrid.recordCount());
+    if ( start >= stop) {
+        return std::vector<QVariant>();
+    }
     std::vector<QVariant> data(stop - start);
+    if ( index >= _datagrid.columnCount()) { // defined but never filled
+        return data;
+    }
+    const TableColumn& col = _datagrid.column(index);
     for(quint32 i=start; i < stop; ++i) {
-        data[i - start] = _datagrid[i].cell(index);
+        data[i - start] = col.value(i);
     }
     return data;
 }
@@ -151,30 +165,77 @@ void FlatTable::column(const QString &nme, const std::vector<QVariant> &vars, qu
         return ;
     }
 
+    ensureColumns();
+    quint32 existing = _datagrid.recordCount();
+    if ( offset + vars.size() > existing) {
+        _datagrid.recordCount(offset + vars.size());
+        recordCount(_datagrid.recordCount());
+    }
     quint32 rec = offset;
     _attributeDefinition[index].changed(true);
     for(const QVariant& var : vars) {
-        if ( rec < _datagrid.size()){
-            _datagrid[rec].changed(true);
-            _datagrid[rec++].cell(index, var);
+        if ( rec < existing){
+            _datagrid.cell(index, rec++, var);
         }
         else {
-            _datagrid.push_back(std::vector<QVariant>(_attributeDefinition.definitionCount()));
-            _datagrid[rec].changed(true);
-            _datagrid[rec++].cell(index,checkInput(var,index));
-            recordCount(_datagrid.size());
+            _datagrid.cell(index, rec++, checkInput(var,index));
         }
     }
 
 }
 
+ColumnSpan<double> FlatTable::realColumn(quint32 index, std::vector<double> &buffer) const
+{
+    if (!const_cast<FlatTable *>(this)->initLoad()) {
+        return ColumnSpan<double>();
+    }
+    if ( index < _datagrid.columnCount() && _datagrid.column(index).reals()) {
+        return ColumnSpan<double>(_datagrid.column(index).reals(), _datagrid.recordCount());
+    }
+    return BaseTable::realColumn(index, buffer);
+}
+
+ColumnSpan<quint32> FlatTable::integerColumn(quint32 index, std::vector<quint32> &buffer) const
+{
+    if (!const_cast<FlatTable *>(this)->initLoad()) {
+        return ColumnSpan<quint32>();
+    }
+    if ( index < _datagrid.columnCount() && _datagrid.column(index).integers()) {
+        return ColumnSpan<quint32>(_datagrid.column(index).integers(), _datagrid.recordCount());
+    }
+    return BaseTable::integerColumn(index, buffer);
+}
+
+void FlatTable::realColumn(quint32 index, const double *values, quint32 count, quint32 offset)
+{
+    if (!initLoad()) {
+        return ;
+    }
+    if (index >= columnCount()) {
+        ERROR2(ERR_ILLEGAL_VALUE_2,"Column index", name());
+        return ;
+    }
+    if ( isReadOnly()) {
+        return ;
+    }
+    ensureColumns();
+    // new records and columns that are not stored as doubles take the generic route
+    if ( offset + count > _datagrid.recordCount() || _datagrid.column(index).storageType() != TableColumn::stREAL) {
+        BaseTable::realColumn(index, values, count, offset);
+        return;
+    }
+    changed(true);
+    _attributeDefinition[index].changed(true);
+    _datagrid.reals(index, offset, values, count);
+}
+
 const Record& FlatTable::record(quint32 rec) const{
     if (!const_cast<FlatTable *>(this)->initLoad()) {
         throw ErrorObject(QString(TR("failed load of table %1")).arg(name()));
     }
 
-    if ( rec < recordCount() && _datagrid.size() != 0) {
-         return _datagrid[rec];
+    if ( rec < recordCount() && rec < _datagrid.recordCount()) {
+         return view(rec);
     }
     throw ErrorObject(QString("Requested record number is not in the table").arg(rec));
 }
@@ -185,8 +246,8 @@ Record& FlatTable::recordRef(quint32 rec)
         throw ErrorObject(QString(TR("failed load of table %1")).arg(name()));
     }
 
-    if ( rec < recordCount() && _datagrid.size() != 0) {
-         return _datagrid[rec];
+    if ( rec < recordCount() && rec < _datagrid.recordCount()) {
+         return view(rec);
     }
     throw ErrorObject(QString("Requested record number is not in the table").arg(rec));
 }
@@ -202,18 +263,18 @@ void FlatTable::record(quint32 rec, const std::vector<QVariant>& vars, quint32 o
         return ;
     }
     changed(true);
-    if ( rec >=_datagrid.size() ) {
-        _datagrid.push_back(std::vector<QVariant>(_attributeDefinition.definitionCount()));
-        _datagrid.back().changed(true);
-        recordCount(_datagrid.size());
+    ensureColumns();
+    if ( rec >= _datagrid.recordCount() ) {
+        _datagrid.recordCount(_datagrid.recordCount() + 1);
+        recordCount(_datagrid.recordCount());
         rec = recordCount() - 1;
+        _datagrid.changed(rec, true);
     }
     quint32 col = offset;
     int cols = std::min((quint32)vars.size() - offset, columnCount());
     for(const QVariant& var : vars) {
         if ( col < cols){
-            _datagrid[rec].changed(true);
-            _datagrid[rec].cell(col, checkInput(var, col));
+            _datagrid.cell(col, rec, checkInput(var, col));
             ++col;
         }
     }
@@ -238,7 +299,7 @@ QVariant FlatTable::cell(const quint32 index, quint32 rec, bool asRaw) const
         return QVariant();
     }
     if ( rec < recordCount()) {
-        QVariant var = _datagrid[rec].cell(index);
+        QVariant var = _datagrid.cell(index, rec);
         if ( !asRaw) {
             ColumnDefinition coldef = columndefinition(index);
             return coldef.datadef().domain<>()->impliedValue(var);
@@ -265,11 +326,10 @@ void  FlatTable::setCell(quint32 index, quint32 rec, const QVariant& var){
 
     _attributeDefinition[index].changed(true);
 
-    if ( rec >= _datagrid.size()) {
+    if ( rec >= _datagrid.recordCount()) {
         newRecord();
     }
-    _datagrid[rec].cell(index, checkInput(var, index));
-    _datagrid[rec].changed(true);
+    _datagrid.cell(index, rec, checkInput(var, index));
 
 }
 
@@ -300,9 +360,7 @@ IlwisObject *FlatTable::clone()
         FlatTable *tbl = new FlatTable();
         copyTo(tbl);
         tbl->_datagrid = _datagrid;
-        for(auto& record : tbl->_datagrid){
-            record.changed(false);
-        }
+        tbl->_datagrid.changed(false);
         return tbl;
     }
     return 0;
@@ -319,7 +377,7 @@ bool FlatTable::initLoad(){
 
     bool ok = BaseTable::initLoad();
 
-    for(int i=0; ok && i < columnCount() && _datagrid.size() > 0; ++i){
+    for(int i=0; ok && i < columnCount() && _datagrid.recordCount() > 0; ++i){
         QVariant var = cell(i,0);
         if ( !var.isValid()) {
             initValuesColumn(columndefinition(i).name());
@@ -327,3 +385,33 @@ bool FlatTable::initLoad(){
     }
     return ok;
 }
+
+bool FlatTable::columnVersion(quint32 columnIndex, quint64 &version) const
+{
+    // all writes, also those through the record views, end in the column store, which counts them per column
+    version = columnIndex < _datagrid.columnCount() ? _datagrid.column(columnIndex).version() : 0;
+    return true;
+}
+
+void FlatTable::ensureColumns()
+{
+    // columns may have been defined while the data was not loaded, or through the BaseTable interface
+    for(quint32 col = _datagrid.columnCount(); col < _attributeDefinition.definitionCount(); ++col) {
+        _datagrid.addColumn(TableColumn::storageType(_attributeDefinition.columndefinition(col)));
+    }
+}
+
+Record &FlatTable::view(quint32 rec) const
+{
+    if ( !recordViews.hasLocalData()) {
+        recordViews.setLocalData(new RecordViews());
+        recordViews.localData()->_views.resize(RECORDVIEWS);
+    }
+    RecordViews *views = recordViews.localData();
+    Record& view = views->_views[views->_next];
+    views->_next = (views->_next + 1) % RECORDVIEWS;
+    view._data = std::vector<QVariant>(); // a row copy of the previous user (see Record::cbegin) is not kept
+    view._store = const_cast<ColumnStore *>(&_datagrid);
+    view._row = rec;
+    return view;
+}
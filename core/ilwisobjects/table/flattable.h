@@ -2,8 +2,16 @@
 #define FLATTABLE_H
 
 #include "record.h"
+#include "columnstore.h"
 
 namespace Ilwis {
+/*!
+ * \brief The FlatTable class is a table that keeps its data in memory, column by column
+ *
+ * Each column is one typed array (see ColumnStore); the Records returned by the row interface are views on a row of these arrays.
+ * Nothing is kept per row for them: every thread cycles through a small set of views, so a returned Record reference stays valid
+ * for the next RECORDVIEWS - 1 record calls of the same thread. Keep a copy of the Record for longer use.
+ */
 class KERNELSHARED_EXPORT FlatTable : public BaseTable
 {
 public:
@@ -49,6 +57,15 @@ public:
     //@override
     void column(quint32 index, const std::vector<QVariant>& vars, quint32 offset);
 
+    //@override
+    ColumnSpan<double> realColumn(quint32 index, std::vector<double>& buffer) const;
+
+    //@override
+    ColumnSpan<quint32> integerColumn(quint32 index, std::vector<quint32>& buffer) const;
+
+    //@override
+    void realColumn(quint32 index, const double *values, quint32 count, quint32 offset=0);
+
     //@override
     QVariant cell(const QString& col, quint32 rec, bool asRaw=true) const;
 
@@ -88,9 +105,16 @@ protected:
             return false;
     }
     void copyTo(IlwisObject *obj);
-    std::vector< Record > _datagrid;
+    ColumnStore _datagrid;
 
     bool initLoad();
+    //@override
+    bool columnVersion(quint32 columnIndex, quint64& version) const;
+private:
+    static const quint32 RECORDVIEWS = 64;
+
+    void ensureColumns();
+    Record& view(quint32 rec) const;
 };
 typedef IlwisData<FlatTable> IFlatTable;
 }
@@ -1,5 +1,6 @@
 #include "kernel.h"
 #include "record.h"
+#include "columnstore.h"
 
 using namespace Ilwis;
 
@@ -26,27 +27,52 @@ Record::Record(const std::vector<QVariant>& data, quint32 offset)
 
 Record::Record(const Record &data)
 {
-    _data = std::vector<QVariant>(data.cbegin(), data.cend());
-    _changed = data._changed;
+    _data = data;
+    _changed = data.isChanged();
+}
+
+Record &Record::operator=(const Record &data)
+{
+    if ( this == &data)
+        return *this;
+    if ( _store) {
+        std::vector<QVariant> values = data;
+        for(quint32 col = 0; col < values.size() && col < columnCount(); ++col)
+            _store->cell(col, _row, values[col]);
+    } else {
+        _data = data;
+        _changed = data.isChanged();
+        _itemid = data._itemid;
+    }
+    return *this;
 }
 
 bool Record::isChanged() const
 {
+    if ( _store)
+        return _store->isChanged(_row);
     return _changed;
 }
 
 void Record::changed(bool yesno)
 {
-    _changed = yesno;
+    if ( _store)
+        _store->changed(_row, yesno);
+    else
+        _changed = yesno;
 }
 
 bool Record::isValid() const
 {
+    if ( _store)
+        return _row < _store->recordCount() && _store->columnCount() != 0;
     return _data.size() != 0;
 }
 
 CRecordIter Record::cbegin() const noexcept
 {
+    if ( _store)
+        _data = _store->record(_row);
     return _data.begin();
 }
 
@@ -57,6 +83,8 @@ CRecordIter Record::cend() const noexcept
 
 QVariant Record::cell(quint32 column) const
 {
+    if ( _store)
+        return _store->cell(column, _row);
     if ( column < _data.size())
         return _data.at(column);
 
@@ -65,6 +93,10 @@ QVariant Record::cell(quint32 column) const
 
 void Record::cell(quint32 column, const QVariant &value)
 {
+    if ( _store) {
+        _store->cell(column, _row, value);
+        return;
+    }
     if ( column < _data.size()){
         _data.at(column) = value;
         _changed = true;
@@ -73,6 +105,8 @@ void Record::cell(quint32 column, const QVariant &value)
 
 quint32 Record::columnCount() const
 {
+    if ( _store)
+        return _store->columnCount();
     return _data.size();
 }
 
@@ -88,15 +122,17 @@ void Record::loadData(const std::vector<IlwisTypes> &types, QDataStream &stream,
     float valf;
     QString vals;
 
-    _data.resize(types.size());
+    if ( !_store)
+        _data.resize(types.size());
     for(int col = 0; col < types.size(); ++col){
+        QVariant value;
         switch(types[col]){
         case itUINT8:
             stream >> valu8;
-            _data[col] = valu8;break;
+            value = valu8;break;
         case itINT8:
             stream >> val8;
-            _data[col] = val8;break;
+            value = val8;break;
         case itUINT32:
         case itINDEXEDITEM:
         case itTHEMATICITEM:
@@ -105,44 +141,50 @@ void Record::loadData(const std::vector<IlwisTypes> &types, QDataStream &stream,
         case itPALETTECOLOR:
         case itCONTINUOUSCOLOR:
             stream >> valu32;
-            _data[col] = valu32;break;
+            value = valu32;break;
         case itINT32:
             stream >> val32;
-            _data[col] = val32;break;
+            value = val32;break;
         case itUINT64:
             stream >> valu64;
-            _data[col] = valu64;break;
+            value = valu64;break;
         case itINT64:
             stream >> val64;
-            _data[col] = val64;break;
+            value = val64;break;
         case itDOUBLE:
             stream >> vald;
-            _data[col] = vald;break;
+            value = vald;break;
         case itFLOAT:
             stream >> valf;
-            _data[col] = valf;break;
+            value = valf;break;
         case itSTRING:
             stream >> vals;
-            _data[col] = vals;break;
+            value = vals;break;
         }
+        if ( _store)
+            _store->cell(col, _row, value);
+        else
+            _data[col] = value;
     }
 }
 
 Ilwis::Record::operator std::vector<QVariant>() const
 {
+    if ( _store)
+        return _store->record(_row);
     std::vector<QVariant> outdata(_data.begin(), _data.end());
 
     return outdata;
 }
 
 void Record::storeData(const std::vector<IlwisTypes>& types, QDataStream& stream,const IOOptions &options){
-    for(int col = 0; col < _data.size(); ++col){
-
+    for(int col = 0; col < columnCount(); ++col){
+        QVariant value = cell(col);
         switch (types[col]){
         case itUINT8:
-            stream << _data[col].toUInt();break;
+            stream << value.toUInt();break;
         case itINT8:
-            stream << _data[col].toInt();break;
+            stream << value.toInt();break;
         case itUINT32:
         case itINDEXEDITEM:
         case itTHEMATICITEM:
@@ -150,19 +192,19 @@ void Record::storeData(const std::vector<IlwisTypes>& types, QDataStream& stream
         case itNUMERICITEM:
         case itPALETTECOLOR:
         case itCONTINUOUSCOLOR:
-            stream << _data[col].toUInt();break;
+            stream << value.toUInt();break;
         case itINT32:
-            stream << _data[col].toInt();break;
+            stream << value.toInt();break;
         case itUINT64:
-            stream << _data[col].toULongLong();break;
+            stream << value.toULongLong();break;
         case itINT64:
-            stream << _data[col].toLongLong();break;
+            stream << value.toLongLong();break;
         case itDOUBLE:
-            stream << _data[col].toDouble();break;
+            stream << value.toDouble();break;
         case itFLOAT:
-            stream << _data[col].toFloat();break;
+            stream << value.toFloat();break;
         case itSTRING:
-            stream << _data[col].toString();break;
+            stream << value.toString();break;
         }
     }
 }
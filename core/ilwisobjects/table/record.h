@@ -6,7 +6,15 @@ namespace Ilwis {
 typedef std::vector<QVariant>::const_iterator CRecordIter;
 typedef std::vector<QVariant>::iterator RecordIter;
 
+class ColumnStore;
 
+/*!
+ * \brief The Record class is one row of attribute values
+ *
+ * A Record either owns its values (e.g. the attributes of a feature) or it is a view on a row of the columnar data of a FlatTable;
+ * a view reads and writes the cells in the columns of the table. Copying a view gives a Record that owns a copy of the values, assigning to
+ * a view writes the values into the row.
+ */
 class KERNELSHARED_EXPORT Record // : private std::vector<QVariant>
 {
 public:
@@ -16,6 +24,7 @@ public:
     Record();
     Record(const std::vector<QVariant> &data, quint32 offset = 0);
     Record(const Record& data);
+    Record& operator=(const Record& data);
 
     bool isChanged() const;
     void changed(bool yesno);
@@ -23,6 +32,9 @@ public:
 
     operator std::vector<QVariant>() const;
 
+    /*!
+     * for a view the iterators walk over a copy of the row that is made by cbegin(); it is dropped when the view is handed out again
+     */
     CRecordIter cbegin() const noexcept;
     CRecordIter cend() const noexcept;
     QVariant cell(quint32 column) const;
@@ -43,7 +55,9 @@ private:
 
     bool _changed = false;
     quint64 _itemid = i64UNDEF;
-    std::vector<QVariant> _data;
+    mutable std::vector<QVariant> _data;
+    ColumnStore *_store = 0;
+    quint32 _row = 0;
 
 };
 }
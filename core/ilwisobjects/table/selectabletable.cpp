@@ -29,3 +29,34 @@ std::vector<quint32> SelectableTable::select(const QString &conditions) const
 {
     return TableSelector::select(this, conditions);
 }
+
+ColumnSpan<double> SelectableTable::realColumn(quint32 index, std::vector<double> &buffer) const
+{
+    // the generic way; tables that store their columns typed can hand out their own storage
+    std::vector<QVariant> data = column(index);
+    buffer.resize(data.size());
+    for(quint32 i = 0; i < data.size(); ++i) {
+        bool ok;
+        double v = data[i].toDouble(&ok);
+        buffer[i] = ok ? v : rUNDEF;
+    }
+    return ColumnSpan<double>(buffer.data(), buffer.size());
+}
+
+ColumnSpan<quint32> SelectableTable::integerColumn(quint32 index, std::vector<quint32> &buffer) const
+{
+    std::vector<QVariant> data = column(index);
+    buffer.resize(data.size());
+    for(quint32 i = 0; i < data.size(); ++i) {
+        bool ok;
+        quint32 v = data[i].toUInt(&ok);
+        buffer[i] = ok ? v : iUNDEF;
+    }
+    return ColumnSpan<quint32>(buffer.data(), buffer.size());
+}
+
+void SelectableTable::realColumn(quint32 index, const double *values, quint32 count, quint32 offset)
+{
+    std::vector<QVariant> vars(values, values + count);
+    column(index, vars, offset);
+}
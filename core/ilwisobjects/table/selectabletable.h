@@ -17,6 +17,15 @@ public:
     ~SelectableTable();
 
     std::vector<quint32> select(const QString& conditions) const;
+
+    //@override
+    virtual ColumnSpan<double> realColumn(quint32 index, std::vector<double>& buffer) const;
+
+    //@override
+    virtual ColumnSpan<quint32> integerColumn(quint32 index, std::vector<quint32>& buffer) const;
+
+    //@override
+    virtual void realColumn(quint32 index, const double *values, quint32 count, quint32 offset=0);
 };
 
 }
@@ -13,6 +13,26 @@ class ColumnDefinition;
 
 static const quint32 NEW_RECORD=1e9;
 
+/*!
+ * \brief The ColumnSpan class is a read-only view on the values of a table column in a plain array
+ *
+ * The array is either the storage of the table itself or a buffer of the caller that was filled because the column is not stored in that type.
+ * Either way the span is only valid as long as the table (or the buffer) is not changed. Cells without a value read as rUNDEF or iUNDEF.
+ */
+template<typename T> class ColumnSpan {
+public:
+    ColumnSpan(const T *values=0, quint32 count=0) : _values(values), _count(count) {}
+
+    const T *begin() const { return _values; }
+    const T *end() const { return _values + _count; }
+    const T& operator[](quint32 index) const { return _values[index]; }
+    quint32 size() const { return _count; }
+
+private:
+    const T *_values;
+    quint32 _count;
+};
+
 /*!
  * Generic interface for tabular data in Ilwis. In Ilwis a table is a structure with rows and columns in 2D. There are two main implementations of the table
  * - FlatTable. A in memory 2D grid of values. It is has no connection to a database. It exists in places were performance is needed
@@ -202,6 +222,36 @@ public:
      */
     virtual void column(const quint32 index, const std::vector<QVariant>& vars, quint32 offset=0) = 0;
 
+    /*!
+     * returns the numeric values of a column as a plain array. When the table stores the column as doubles no values are copied,
+     * else the values are converted into buffer. Cells without a (numeric) value are rUNDEF
+     *
+     * \param index the index of the column
+     * \param buffer storage for the converted values, only used when the column is not stored as doubles
+     * \return a view on the values, empty when the column does not exist
+     */
+    virtual ColumnSpan<double> realColumn(quint32 index, std::vector<double>& buffer) const = 0;
+
+    /*!
+     * returns the raw values of a column with an item domain as a plain array. When the table stores the column as raws no values are copied,
+     * else the values are converted into buffer. Cells without a value are iUNDEF
+     *
+     * \param index the index of the column
+     * \param buffer storage for the converted values, only used when the column is not stored as raws
+     * \return a view on the values, empty when the column does not exist
+     */
+    virtual ColumnSpan<quint32> integerColumn(quint32 index, std::vector<quint32>& buffer) const = 0;
+
+    /*!
+     * sets a numeric column from a plain array; the numeric counterpart of column(index, vars, offset)
+     *
+     * \param index index of the column to be set
+     * \param values the values of the rows
+     * \param count the number of values
+     * \param offset starting row form where the values are set. If the number of values to be added goes beyond the size of the table, new records will be added
+     */
+    virtual void realColumn(quint32 index, const double *values, quint32 count, quint32 offset=0) = 0;
+
     /*!
      * returns the value of a single record/field combination ( a cell).<br>
      * Disabling asRaw (setting it to false) has negative effects on performance.
@@ -1,3 +1,6 @@
+#include <future>
+#include <unordered_map>
+#include <QThread>
 #include "kernel.h"
 #include "ilwisdata.h"
 #include "domain.h"
@@ -19,6 +22,66 @@
 
 using namespace Ilwis;
 
+namespace {
+typedef std::vector<std::pair<quint32, quint32>> JoinPairs;
+
+struct KeyHash {
+    std::size_t operator()(double key) const { return std::hash<double>()(key); }
+    std::size_t operator()(const QString& key) const { return qHash(key); }
+};
+
+bool isKey(double key) { return !isNumericalUndef(key); }
+bool isKey(const QString& key) { return key != sUNDEF && !key.isEmpty(); }
+
+// gives the pairs (left record, right record) with equal keys in the order of the left records; right record is iUNDEF for
+// the unmatched records of a left join
+template<typename KeyType> void hashJoin(const std::vector<KeyType>& leftKeys, const std::vector<KeyType>& rightKeys, bool leftJoin, JoinPairs& pairs)
+{
+    // the hash is built on the smaller side; a left join must visit every left record, so it always builds on the right side
+    bool buildLeft = !leftJoin && leftKeys.size() < rightKeys.size();
+    const std::vector<KeyType>& buildKeys = buildLeft ? leftKeys : rightKeys;
+    const std::vector<KeyType>& probeKeys = buildLeft ? rightKeys : leftKeys;
+
+    std::unordered_multimap<KeyType, quint32, KeyHash> hashtable;
+    hashtable.reserve(buildKeys.size());
+    for(quint32 rec = 0; rec < buildKeys.size(); ++rec)
+        if ( isKey(buildKeys[rec]))
+            hashtable.emplace(buildKeys[rec], rec);
+
+    // the hash table is only read while probing, so the chunks need no locking; small tables are not worth a thread
+    quint32 probeCount = probeKeys.size();
+    int cores = std::max(1, std::min(QThread::idealThreadCount(), (int)(probeCount / 10000)));
+    quint32 chunk = (probeCount + cores - 1) / cores;
+    auto probe = [&](quint32 first, quint32 last) -> JoinPairs {
+        JoinPairs found;
+        for(quint32 rec = first; rec < last; ++rec) {
+            bool matched = false;
+            if ( isKey(probeKeys[rec])) {
+                auto range = hashtable.equal_range(probeKeys[rec]);
+                for(auto iter = range.first; iter != range.second; ++iter) {
+                    found.push_back(buildLeft ? std::make_pair((*iter).second, rec) : std::make_pair(rec, (*iter).second));
+                    matched = true;
+                }
+            }
+            if ( !matched && leftJoin)
+                found.push_back(std::make_pair(rec, (quint32)iUNDEF));
+        }
+        return found;
+    };
+    std::vector<std::future<JoinPairs>> futures(cores);
+    for(int i = 0; i < cores; ++i)
+        futures[i] = std::async(std::launch::async, probe, std::min(i * chunk, probeCount), std::min((i + 1) * chunk, probeCount));
+
+    pairs.clear();
+    for(int i = 0; i < cores; ++i) {
+        JoinPairs found = futures[i].get();
+        pairs.insert(pairs.end(), found.begin(), found.end());
+    }
+    if ( buildLeft)
+        std::sort(pairs.begin(), pairs.end());
+}
+}
+
 TableMerger::TableMerger()
 {
 }
@@ -166,17 +229,178 @@ void TableMerger::mergeTableData(const ITable &sourceTable1,const ITable &source
         std::map<QString, RenumberMap>::const_iterator iterR;
         if ( (iterR = _renumberers.find(targetColName)) != _renumberers.end()) {
             const RenumberMap& renumberer = (*iterR).second;
-            for(auto pair : renumberer) {
-                for(auto& val : values) {
-                    if ( pair.first == val)
-                        val = pair.second;
-                }
+            // one lookup per value instead of a pass over all values for every renumbered raw
+            for(auto& val : values) {
+                bool ok;
+                auto iterRaw = renumberer.find(val.toULongLong(&ok));
+                if ( ok && iterRaw != renumberer.end())
+                    val = (*iterRaw).second;
             }
         }
         targetTable->column(targetColName,values, sourceTable1->recordCount());
     }
 }
 
+ITable TableMerger::join(const ITable &leftTable, const QString &leftKey, const ITable &rightTable, const QString &rightKey, JoinType type)
+{
+    if (!leftTable.isValid() || !rightTable.isValid()){
+        ERROR1(ERR_NO_INITIALIZED_1, "Tables");
+        return ITable();
+    }
+    quint32 leftColumn = leftTable->columnIndex(leftKey);
+    quint32 rightColumn = rightTable->columnIndex(rightKey);
+    if ( leftColumn == iUNDEF) {
+        ERROR2(ERR_NOT_FOUND2, leftKey, leftTable->name());
+        return ITable();
+    }
+    if ( rightColumn == iUNDEF) {
+        ERROR2(ERR_NOT_FOUND2, rightKey, rightTable->name());
+        return ITable();
+    }
+    IDomain leftDomain = leftTable->columndefinition(leftColumn).datadef().domain<>();
+    IDomain rightDomain = rightTable->columndefinition(rightColumn).datadef().domain<>();
+    if ( !leftDomain.isValid() || !rightDomain.isValid()) {
+        ERROR2(ERR_NO_INITIALIZED_2, "domain", leftKey);
+        return ITable();
+    }
+
+    JoinPairs pairs;
+    bool leftJoin = type == jtLEFT;
+    if ( hasType(leftDomain->ilwisType(), itTEXTDOMAIN) && hasType(rightDomain->ilwisType(), itTEXTDOMAIN)) {
+        std::vector<QVariant> leftData = leftTable->column(leftColumn);
+        std::vector<QVariant> rightData = rightTable->column(rightColumn);
+        std::vector<QString> leftKeys(leftData.size()), rightKeys(rightData.size());
+        for(quint32 i = 0; i < leftData.size(); ++i)
+            leftKeys[i] = leftData[i].toString();
+        for(quint32 i = 0; i < rightData.size(); ++i)
+            rightKeys[i] = rightData[i].toString();
+        hashJoin(leftKeys, rightKeys, leftJoin, pairs);
+    } else {
+        std::vector<double> leftKeys, rightKeys;
+        if ( !joinKeys(leftTable, leftColumn, leftDomain, leftKeys) || !joinKeys(rightTable, rightColumn, leftDomain, rightKeys)) {
+            ERROR2(ERR_NOT_COMPATIBLE2, leftKey, rightKey);
+            return ITable();
+        }
+        hashJoin(leftKeys, rightKeys, leftJoin, pairs);
+    }
+
+    IFlatTable joined;
+    joined.prepare(QString("ilwis://internalcatalog/%1_%2").arg(leftTable->name(), rightTable->name()));
+    quint32 index = 0;
+    std::vector<quint32> rightColumns;
+    for(quint32 col = 0; col < leftTable->columnCount(); ++col)
+        joined->addColumn(ColumnDefinition(leftTable->columndefinition(col), index++));
+    for(quint32 col = 0; col < rightTable->columnCount(); ++col) {
+        if ( col == rightColumn)
+            continue;
+        ColumnDefinition coldef(rightTable->columndefinition(col), index++);
+        if ( leftTable->columnIndex(coldef.name()) != iUNDEF)
+            coldef.name(rightTable->name() + "_" + coldef.name());
+        joined->addColumn(coldef);
+        rightColumns.push_back(col);
+    }
+    joined->recordCount(pairs.size());
+    if ( pairs.size() > 0)
+        joined->createTable(); // sizes the columns, so the typed columns below are written in place
+
+    // the data is moved column by column, so every column of the result is written in one go
+    ITable target = joined;
+    std::vector<quint32> records(pairs.size());
+    for(quint32 i = 0; i < pairs.size(); ++i)
+        records[i] = pairs[i].first;
+    for(quint32 col = 0; col < leftTable->columnCount(); ++col)
+        joinColumn(leftTable, col, records, target, col);
+    for(quint32 i = 0; i < pairs.size(); ++i)
+        records[i] = pairs[i].second;
+    for(quint32 i = 0; i < rightColumns.size(); ++i)
+        joinColumn(rightTable, rightColumns[i], records, target, leftTable->columnCount() + i);
+
+    return target;
+}
+
+bool TableMerger::joinKeys(const ITable &table, quint32 column, const IDomain &keyDomain, std::vector<double> &keys) const
+{
+    IDomain dom = table->columndefinition(column).datadef().domain<>();
+    if ( hasType(keyDomain->ilwisType(), itITEMDOMAIN)) {
+        SPItemRange keyRange = keyDomain->range<ItemRange>();
+        if ( hasType(dom->ilwisType(), itITEMDOMAIN)) {
+            std::vector<quint32> buffer;
+            ColumnSpan<quint32> raws = table->integerColumn(column, buffer);
+            keys.resize(raws.size());
+            if ( dom->id() == keyDomain->id()) {
+                for(quint32 i = 0; i < raws.size(); ++i)
+                    keys[i] = raws[i] == (quint32)iUNDEF ? rUNDEF : raws[i];
+                return true;
+            }
+            // items of another domain match on their names; every raw is translated once
+            SPItemRange range = dom->range<ItemRange>();
+            if ( range.isNull() || keyRange.isNull())
+                return false;
+            std::unordered_map<quint32, double> translated;
+            for(quint32 i = 0; i < raws.size(); ++i) {
+                auto iter = translated.find(raws[i]);
+                if ( iter == translated.end()) {
+                    SPDomainItem item = range->item(raws[i]);
+                    SPDomainItem keyItem = item.isNull() ? SPDomainItem() : keyRange->item(item->name());
+                    iter = translated.emplace(raws[i], keyItem.isNull() ? rUNDEF : keyItem->raw()).first;
+                }
+                keys[i] = (*iter).second;
+            }
+            return true;
+        }
+        if ( hasType(dom->ilwisType(), itTEXTDOMAIN) && !keyRange.isNull()) {
+            std::vector<QVariant> names = table->column(column);
+            keys.resize(names.size());
+            for(quint32 i = 0; i < names.size(); ++i) {
+                SPDomainItem keyItem = keyRange->item(names[i].toString());
+                keys[i] = keyItem.isNull() ? rUNDEF : keyItem->raw();
+            }
+            return true;
+        }
+        return false;
+    }
+    if ( hasType(keyDomain->valueType(), itNUMBER) && hasType(dom->valueType(), itNUMBER)) {
+        if ( hasType(dom->valueType(), itDATETIME)) {
+            std::vector<QVariant> data = table->column(column);
+            keys.resize(data.size());
+            for(quint32 i = 0; i < data.size(); ++i)
+                keys[i] = (double)data[i].value<Ilwis::Time>();
+            return true;
+        }
+        std::vector<double> buffer;
+        ColumnSpan<double> values = table->realColumn(column, buffer);
+        keys.assign(values.begin(), values.end());
+        return true;
+    }
+    return false;
+}
+
+void TableMerger::joinColumn(const ITable &source, quint32 sourceColumn, const std::vector<quint32> &records, ITable &target, quint32 targetColumn) const
+{
+    IDomain dom = source->columndefinition(sourceColumn).datadef().domain<>();
+    IlwisTypes valueType = dom.isValid() ? dom->valueType() : itUNKNOWN;
+    if ( hasType(valueType, itNUMBER) && !hasType(valueType, itDATETIME)) {
+        std::vector<double> buffer;
+        ColumnSpan<double> values = source->realColumn(sourceColumn, buffer);
+        std::vector<double> result(records.size());
+        for(quint32 i = 0; i < records.size(); ++i)
+            result[i] = records[i] < values.size() ? values[records[i]] : rUNDEF;
+        target->realColumn(targetColumn, result.data(), result.size());
+        return;
+    }
+
+    QVariant undefined;
+    if ( dom.isValid() && hasType(dom->ilwisType(), itITEMDOMAIN))
+        undefined = QVariant((int)iUNDEF);
+    else if ( dom.isValid() && hasType(dom->ilwisType(), itTEXTDOMAIN))
+        undefined = sUNDEF;
+    std::vector<QVariant> values = source->column(sourceColumn);
+    std::vector<QVariant> result(records.size());
+    for(quint32 i = 0; i < records.size(); ++i)
+        result[i] = records[i] < values.size() ? values[records[i]] : undefined;
+    target->column(targetColumn, result);
+}
+
 ColumnDefinition TableMerger::mergeColumnDefinitions(const ColumnDefinition &def1, const ColumnDefinition &def2, RenumberMap *renumberer) {
     Range *rng = 0;
 
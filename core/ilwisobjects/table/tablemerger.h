@@ -5,15 +5,30 @@ namespace Ilwis {
 class KERNELSHARED_EXPORT TableMerger
 {
 public:
+    enum JoinType{ jtINNER, jtLEFT };
+
     TableMerger();
     ITable mergeMetadataTables(const ITable &tbl1, const ITable &tbl2);
     bool mergeMetadataTables(ITable &tblOut, const ITable &tblIn, const std::vector<QString> &columns);
     void mergeTableData(const ITable &sourceTable1,const ITable &sourceTable2, ITable &targetTable, const std::vector<QString>& except=std::vector<QString>()) const;
     bool copyColumns(const ITable &tblSource, ITable &tbltarget, int options=0);
+    /*!
+     * \brief join combines the records of two tables that have the same value in their key columns
+     *
+     * The keys are compared typed: raws for item columns (through the item names when the two columns have different domains),
+     * numbers for numeric columns and texts for text columns; undefined keys match nothing. A hash table is built on the keys of one
+     * table and the keys of the other are looked up in it in parallel chunks. The result is a new (columnar) FlatTable with the columns
+     * of leftTable followed by the columns of rightTable except its key column, in the order of the records of leftTable.
+     * \param type jtINNER keeps only the records that match, jtLEFT keeps every record of leftTable and fills the columns of rightTable with undefined when there is no match
+     * \return the joined table, invalid if the key columns do not exist or can not be compared
+     */
+    ITable join(const ITable& leftTable, const QString& leftKey, const ITable& rightTable, const QString& rightKey, JoinType type=jtINNER);
 private:
     std::map<QString, RenumberMap> _renumberers;
     std::map<QString, QString> _columnRenames;
     ColumnDefinition mergeColumnDefinitions(const Ilwis::ColumnDefinition &def1, const Ilwis::ColumnDefinition &def2, RenumberMap* renum=0);
+    bool joinKeys(const ITable& table, quint32 column, const IDomain& keyDomain, std::vector<double>& keys) const;
+    void joinColumn(const ITable& source, quint32 sourceColumn, const std::vector<quint32>& records, ITable& target, quint32 targetColumn) const;
 };
 }
 
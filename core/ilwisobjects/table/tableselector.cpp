@@ -3,6 +3,7 @@
 #include "domain.h"
 #include "domainitem.h"
 #include "itemdomain.h"
+#include "itemrange.h"
 #include "range.h"
 #include "datadefinition.h"
 #include "columndefinition.h"
@@ -14,6 +15,26 @@
 
 using namespace Ilwis;
 
+namespace {
+// folds the outcome of one condition into the selection, as the connector of the condition says
+template<typename T, typename Test> void combine(const T *values, quint32 count, LogicalOperator connector, quint8 *status, Test test)
+{
+    switch(connector){
+    case loAND:
+        for(quint32 i = 0; i < count; ++i)
+            status[i] &= test(values[i]);
+        break;
+    case loOR:
+        for(quint32 i = 0; i < count; ++i)
+            status[i] |= test(values[i]);
+        break;
+    default:
+        for(quint32 i = 0; i < count; ++i)
+            status[i] = test(values[i]);
+    }
+}
+}
+
 TableSelector::TableSelector()
 {
 }
@@ -24,170 +45,220 @@ std::vector<quint32> TableSelector::select(const Table* table, const QString &co
     if ( !parser.isValid()) {
         return std::vector<quint32>();
     }
-    std::vector<bool> status(table->recordCount(),false);
-    for(auto part : parser.parts()) {
-        std::vector<QVariant> data = table->column(part.field());
-        if (data.size() == 0) {
+    // all parts are compiled before any column is read
+    std::vector<LogicalExpressionPart> parts = parser.parts();
+    std::vector<Predicate> program(parts.size());
+    for(quint32 i = 0; i < parts.size(); ++i) {
+        if (!compile(table, parts[i], program[i])) {
             ERROR2(ERR_ILLEGAL_VALUE_2,TR("expression"), conditions);
             return std::vector<quint32>();
         }
-        const ColumnDefinition& coldef = const_cast<Table *>(table)->columndefinitionRef(part.field());
-
-        auto iter = status.begin();
-        IlwisTypes vt = coldef.datadef().domain()->valueType();
-        for(const QVariant& var : data) {
-            if ( hasType(vt, itNUMBER)){
-                if ( hasType(vt, itDATETIME))
-                    numericCase(part, (double)var.value<Ilwis::Time>(), iter);
-                else
-                    numericCase(part, var.toDouble(), iter);
-            }
-            else if ( hasType(vt, itSTRING )){
-                stringCase(part, coldef, var, iter);
-            }
-            ++iter;
-        }
+    }
 
+    std::vector<quint8> status(table->recordCount(),0);
+    for(quint32 i = 0; i < program.size(); ++i) {
+        const Predicate& predicate = program[i];
+        // the parts are combined from left to right, so an AND on an empty selection or an OR on a full one changes nothing
+        if ( predicate._connector == loAND && std::find(status.begin(), status.end(), 1) == status.end())
+            continue;
+        if ( predicate._connector == loOR && std::find(status.begin(), status.end(), 0) == status.end())
+            continue;
+        evaluate(table, predicate, status);
     }
+
     std::vector<quint32> result;
-    for(int i=0; i < status.size(); ++i)
+    for(quint32 i=0; i < status.size(); ++i)
         if(status[i])
             result.push_back(i);
 
     return result;
 }
-void TableSelector::stringCase(const LogicalExpressionPart& part, const ColumnDefinition& coldef, const QVariant& var, std::vector<bool>::iterator& iter) {
-    QString text = part.value();
-    QString fieldtxt = var.toString();
-    if ( coldef.datadef().domain<>()->valueType() == itTHEMATICITEM){
-        quint32 raw = var.toUInt();
-        INamedIdDomain domainid = coldef.datadef().domain<>().as<NamedIdDomain>();
-        SPDomainItem item = domainid->item(raw);
-        fieldtxt = item->name();
-    }
-    LogicalOperator lconnector =  part.logicalConnector();
-    switch(part.condition()){
-    case loEQ:{
-        switch(lconnector){
-        case loNONE:
-            *iter = fieldtxt == text;break;
-        case loOR:
-            *iter = *iter || fieldtxt == text;break;
-        case loAND:
-            *iter = *iter && fieldtxt == text;break;
-        default:
-            *iter = false;break;
+
+bool TableSelector::compile(const Table *table, const LogicalExpressionPart &part, Predicate &predicate)
+{
+    predicate._column = table->columnIndex(part.field());
+    if ( predicate._column == iUNDEF)
+        return false;
+    const ColumnDefinition& coldef = const_cast<Table *>(table)->columndefinitionRef(predicate._column);
+    if ( !coldef.isValid() || !coldef.datadef().domain<>().isValid())
+        return false;
+
+    predicate._condition = part.condition();
+    predicate._connector = part.logicalConnector();
+    IDomain dom = coldef.datadef().domain<>();
+    IlwisTypes vt = dom->valueType();
+    QString value = part.value();
+    if ( hasType(vt, itNUMBER)){
+        predicate._kind = hasType(vt, itDATETIME) ? Predicate::pkDATETIME : Predicate::pkNUMBER;
+        predicate._number = value == "?" ? rUNDEF : value.toDouble();
+    } else if ( hasType(vt, itDOMAINITEM)){
+        // item names are looked up once; a name that is not in the domain matches no record
+        predicate._kind = Predicate::pkRAW;
+        if ( value == "?")
+            predicate._raw = iUNDEF;
+        else {
+            SPItemRange rng = dom->range<ItemRange>();
+            SPDomainItem item = rng.isNull() ? SPDomainItem() : rng->item(value);
+            predicate._raw = item.isNull() ? iILLEGAL : item->raw();
         }
+    } else if ( hasType(vt, itSTRING)){
+        predicate._kind = Predicate::pkTEXT;
+        predicate._text = value;
+    } else
+        predicate._kind = Predicate::pkFALSE;
+
+    return true;
+}
+
+void TableSelector::evaluate(const Table *table, const Predicate &predicate, std::vector<quint8> &status)
+{
+    if ( indexed(table, predicate, status))
+        return;
+
+    switch(predicate._kind){
+    case Predicate::pkNUMBER:{
+        std::vector<double> buffer;
+        ColumnSpan<double> values = table->realColumn(predicate._column, buffer);
+        numericCase(predicate, values.begin(), std::min(values.size(), (quint32)status.size()), status.data());
         break;
     }
-    case loNEQ:{
-        switch(lconnector){
-        case loNONE:
-            *iter = fieldtxt != text;break;
-        case loOR:
-            *iter = *iter || fieldtxt != text;break;
-        case loAND:
-            *iter = *iter && fieldtxt != text;break;
-        default:
-            *iter = false;break;
-        }
+    case Predicate::pkDATETIME:{
+        std::vector<QVariant> data = table->column(predicate._column);
+        std::vector<double> values(data.size());
+        for(quint32 i = 0; i < data.size(); ++i)
+            values[i] = (double)data[i].value<Ilwis::Time>();
+        numericCase(predicate, values.data(), std::min(values.size(), status.size()), status.data());
         break;
     }
-    default:
-        *iter = false;
+    case Predicate::pkRAW:{
+        std::vector<quint32> buffer;
+        ColumnSpan<quint32> values = table->integerColumn(predicate._column, buffer);
+        rawCase(predicate, values.begin(), std::min(values.size(), (quint32)status.size()), status.data());
+        break;
+    }
+    case Predicate::pkTEXT:{
+        std::vector<QVariant> values = table->column(predicate._column);
+        values.resize(std::min(values.size(), status.size()));
+        stringCase(predicate, values, status.data());
+        break;
+    }
+    case Predicate::pkFALSE:
+        if ( predicate._connector != loOR)
+            std::fill(status.begin(), status.end(), 0);
+        break;
     }
 }
 
+bool TableSelector::indexed(const Table *table, const Predicate &predicate, std::vector<quint8> &status)
+{
+    const BaseTable *btable = dynamic_cast<const BaseTable *>(table);
+    if ( !btable || !btable->hasIndex(predicate._column))
+        return false;
 
-void TableSelector::numericCase(const LogicalExpressionPart& part, double val1, std::vector<bool>::iterator& iter) {
-    double val2 = rUNDEF;
-    if ( part.value() != "?")
-        val2 = part.value().toDouble();
-    if ( isNumericalUndef(val1))
-        val1 = rUNDEF;
-
-    LogicalOperator lconnector =  part.logicalConnector();
-    switch(part.condition()){
-    case loEQ:{
-        switch(lconnector){
-        case loNONE:
-            *iter = val1 == val2;break;
-        case loOR:
-            *iter = *iter || val1 == val2;break;
-        case loAND:
-            *iter = *iter && val1 == val2;break;
-        default:
-            *iter = false;break;
-        }
-        break;
+    double key;
+    switch(predicate._kind){
+    case Predicate::pkNUMBER:
+    case Predicate::pkDATETIME:
+        key = predicate._number; break;
+    case Predicate::pkRAW:
+        key = predicate._raw; break;
+    default:
+        return false;
     }
-    case loNEQ:{
-        switch(lconnector){
-        case loNONE:
-            *iter = val1 != val2;break;
-        case loOR:
-            *iter = *iter || val1 != val2;break;
-        case loAND:
-            *iter = *iter && val1 != val2;break;
-        default:
-            *iter = false;break;
-        }
+    std::vector<quint32> records;
+    if ( !btable->indexLookup(predicate._column, predicate._condition, key, records))
+        return false; // a condition the index can not answer (e.g. !=), the column is scanned
+
+    switch(predicate._connector){
+    case loAND:{
+        std::vector<quint8> found(status.size(), 0);
+        for(quint32 rec : records)
+            if ( rec < found.size())
+                found[rec] = 1;
+        for(quint32 i = 0; i < status.size(); ++i)
+            status[i] &= found[i];
         break;
     }
-    case loLESS:{
-        switch(lconnector){
-        case loNONE:
-            *iter = (val1 < val2) && val1 !=rUNDEF && val2 != rUNDEF;break;
-        case loOR:
-            *iter = (*iter || val1 < val2) && val1 !=rUNDEF && val2 != rUNDEF;break;
-        case loAND:
-            *iter = (*iter && val1 < val2) && val1 !=rUNDEF && val2 != rUNDEF;break;
-        default:
-            *iter = false;break;
-        }
+    case loOR:
+        for(quint32 rec : records)
+            if ( rec < status.size())
+                status[rec] = 1;
         break;
+    default:
+        std::fill(status.begin(), status.end(), 0);
+        for(quint32 rec : records)
+            if ( rec < status.size())
+                status[rec] = 1;
     }
-    case loLESSEQ:{
-        switch(lconnector){
-        case loNONE:
-            *iter = (val1 <= val2) && val1 !=rUNDEF && val2 != rUNDEF;break;
-        case loOR:
-            *iter = (*iter || val1 <= val2) && val1 !=rUNDEF && val2 != rUNDEF;break;
-        case loAND:
-            *iter = (*iter && val1 <= val2) && val1 !=rUNDEF && val2 != rUNDEF;break;
-        default:
-            *iter = false;break;
-        }
+    return true;
+}
+
+void TableSelector::stringCase(const Predicate &predicate, const std::vector<QVariant> &values, quint8 *status) {
+    const QString& text = predicate._text;
+    switch(predicate._condition){
+    case loEQ:
+        combine(values.data(), values.size(), predicate._connector, status, [&text](const QVariant& v) { return v.toString() == text; });
         break;
+    case loNEQ:
+        combine(values.data(), values.size(), predicate._connector, status, [&text](const QVariant& v) { return v.toString() != text; });
+        break;
+    default:
+        combine(values.data(), values.size(), predicate._connector, status, [](const QVariant&) { return false; });
     }
-    case loGREATEREQ:{
-        switch(lconnector){
-        case loNONE:
-            *iter = (val1 >= val2) && val1 !=rUNDEF && val2 != rUNDEF;break;
-        case loOR:
-            *iter = (*iter || val1 >= val2) && val1 !=rUNDEF && val2 != rUNDEF;break;
-        case loAND:
-            *iter = (*iter && val1 >= val2) && val1 !=rUNDEF && val2 != rUNDEF;break;
-        default:
-            *iter = false;break;
-        }
+}
+
+void TableSelector::rawCase(const Predicate &predicate, const quint32 *values, quint32 count, quint8 *status) {
+    quint32 raw = predicate._raw;
+    switch(predicate._condition){
+    case loEQ:
+        combine(values, count, predicate._connector, status, [raw](quint32 v) { return v == raw; });
         break;
+    case loNEQ:
+        combine(values, count, predicate._connector, status, [raw](quint32 v) { return v != raw; });
+        break;
+    default:
+        combine(values, count, predicate._connector, status, [](quint32) { return false; });
     }
-    case loGREATER:{
-        switch(lconnector){
-        case loNONE:
-            *iter = (val1 > val2) && val1 !=rUNDEF && val2 != rUNDEF;break;
-        case loOR:
-            *iter = (*iter || val1 > val2) && val1 !=rUNDEF && val2 != rUNDEF;break;
-        case loAND:
-            *iter = (*iter && val1 > val2) && val1 !=rUNDEF && val2 != rUNDEF;break;
+}
+
+void TableSelector::numericCase(const Predicate &predicate, const double *values, quint32 count, quint8 *status) {
+    double val2 = predicate._number;
+    LogicalOperator lconnector = predicate._connector;
+    // "?" (undefined) can only be tested for (in)equality; the ordering conditions never hold for undefined values
+    if ( val2 == rUNDEF) {
+        switch(predicate._condition){
+        case loEQ:
+            combine(values, count, lconnector, status, [](double v) { return isNumericalUndef(v); });
+            break;
+        case loNEQ:
+            combine(values, count, lconnector, status, [](double v) { return !isNumericalUndef(v); });
+            break;
         default:
-            *iter = false;break;
+            combine(values, count, lconnector, status, [](double) { return false; });
         }
-        break;
+        return;
     }
-    default:
-        *iter = false;break;
 
+    switch(predicate._condition){
+    case loEQ:
+        combine(values, count, lconnector, status, [val2](double v) { return v == val2; });
+        break;
+    case loNEQ:
+        combine(values, count, lconnector, status, [val2](double v) { return v != val2; });
+        break;
+    case loLESS:
+        combine(values, count, lconnector, status, [val2](double v) { return v < val2 && !isNumericalUndef(v); });
+        break;
+    case loLESSEQ:
+        combine(values, count, lconnector, status, [val2](double v) { return v <= val2 && !isNumericalUndef(v); });
+        break;
+    case loGREATEREQ:
+        combine(values, count, lconnector, status, [val2](double v) { return v >= val2 && !isNumericalUndef(v); });
+        break;
+    case loGREATER:
+        combine(values, count, lconnector, status, [val2](double v) { return v > val2 && !isNumericalUndef(v); });
+        break;
+    default:
+        combine(values, count, lconnector, status, [](double) { return false; });
     }
 }
@@ -6,11 +6,32 @@ class TableSelector
 {
     friend class SelectableTable;
 
+    /*!
+     * \brief The Predicate struct is one part of a selection, compiled against the column it tests
+     *
+     * The value of the condition is converted once to the type in which the column is read: a number for numeric columns, the raw of the item for
+     * item columns and a text for text columns.
+     */
+    struct Predicate {
+        enum Kind{ pkNUMBER, pkDATETIME, pkRAW, pkTEXT, pkFALSE };
+
+        Kind _kind = pkFALSE;
+        quint32 _column = iUNDEF;
+        LogicalOperator _condition = loNONE;
+        LogicalOperator _connector = loNONE;
+        double _number = rUNDEF;
+        quint32 _raw = iUNDEF;
+        QString _text;
+    };
+
     TableSelector();
     static std::vector<quint32> select(const Table *tbl, const QString &conditions) ;
-    static void numericCase(const LogicalExpressionPart &part, double val1, std::vector<bool>::iterator &iter);
-    static void stringCase(const LogicalExpressionPart &part, const Ilwis::ColumnDefinition &coldef,
-                           const QVariant &val1, std::vector<bool>::iterator &iter);
+    static bool compile(const Table *table, const LogicalExpressionPart &part, Predicate &predicate);
+    static void evaluate(const Table *table, const Predicate &predicate, std::vector<quint8> &status);
+    static bool indexed(const Table *table, const Predicate &predicate, std::vector<quint8> &status);
+    static void numericCase(const Predicate &predicate, const double *values, quint32 count, quint8 *status);
+    static void rawCase(const Predicate &predicate, const quint32 *values, quint32 count, quint8 *status);
+    static void stringCase(const Predicate &predicate, const std::vector<QVariant> &values, quint8 *status);
 };
 }
 
@@ -5,6 +5,7 @@
 #include <cmath>
 #include <vector>
 #include <algorithm>
+#include <limits>
 #include <iostream>
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/stats.hpp>
@@ -32,6 +33,58 @@ public:
         quint64 _count;
     };
 
+    /*!
+     * \brief The Partial struct gathers the basic markers of a part of the data.
+     *
+     * Parts filled by different threads can be merged and handed to calculate(const Partial&) afterwards. It is the same
+     * set of markers calculate() produces for pBASIC, without the median. Merging parts in the order of the data gives the same
+     * significant digits as one sequential pass.
+     */
+    struct Partial {
+        DataType _min = std::numeric_limits<DataType>::max();
+        DataType _max = std::numeric_limits<DataType>::lowest();
+        double _sum = 0;
+        quint64 _count = 0;
+        quint64 _nettoCount = 0;
+        // the fractions that were larger than all fractions before them. The digit fold of calculate() never changes on any other
+        // fraction, so these (usually a handful) are enough to redo the fold over the merged parts
+        std::vector<double> _fractions;
+
+        void operator()(const DataType& sample) {
+            ++_count;
+            if ( sample == undef<DataType>())
+                return;
+            fraction(fabs(sample - (qint64)sample));
+            _min = std::min(_min, sample);
+            _max = std::max(_max, sample);
+            _sum += sample;
+            ++_nettoCount;
+        }
+
+        void merge(const Partial& part) {
+            _min = std::min(_min, part._min);
+            _max = std::max(_max, part._max);
+            _sum += part._sum;
+            for(double rest : part._fractions)
+                fraction(rest);
+            _count += part._count;
+            _nettoCount += part._nettoCount;
+        }
+
+        double sigDigits() const {
+            double sigDigits = 0;
+            for(double rest : _fractions)
+                sigDigits = std::max(sigDigits, rest - sigDigits);
+            return sigDigits;
+        }
+
+    private:
+        void fraction(double rest) {
+            if ( rest > (_fractions.empty() ? 0 : _fractions.back()))
+                _fractions.push_back(rest);
+        }
+    };
+
     enum PropertySets{pNONE = 0, pBASIC=1, pMIN=2, pMAX=4, pDISTANCE=8, pDELTA=16,pNETTOCOUNT=32, pCOUNT=64, pSUM=128,
                       pMEAN=256, pMEDIAN=512, pPREDOMINANT=1024, pSTDEV=2048, pHISTOGRAM=4096, pLAST=8192, pALL=4294967296};
 
@@ -194,6 +247,24 @@ public:
         return true;
     }
 
+    bool calculate(const Partial& partial) {
+        std::fill(_markers.begin(), _markers.end(), rUNDEF);
+        if ( partial._nettoCount == 0)
+            return true;
+
+        _markers[index(pMIN)] = partial._min;
+        _markers[index(pMAX)] = partial._max;
+        _markers[index(pDISTANCE)] = std::abs(prop(pMAX) - prop(pMIN));
+        _markers[index(pDELTA)] = prop(pMAX) - prop(pMIN);
+        _markers[index(pNETTOCOUNT)] = partial._nettoCount;
+        _markers[index(pCOUNT)] = partial._count;
+        _markers[index(pSUM)] = partial._sum;
+        _markers[index(pMEAN)] = partial._sum / partial._nettoCount;
+        findSignificantDigits(partial.sigDigits());
+
+        return true;
+    }
+
     bool isValid() const {
         return prop(pMAX) != rUNDEF;
     }
@@ -38,7 +38,9 @@ bool PointRasterCrossing::execute(ExecutionContext *ctx, SymbolTable &symTable)
         if((_prepState = prepare(ctx,symTable)) != sPREPARED)
             return false;
 
-    quint32 record = 0;
+    // the points are gathered first so that the coordinates can be converted to pixels in one batch
+    std::vector<SPFeatureI> newFeatures;
+    std::vector<double> xs, ys;
     for(const auto& infeature : _inputFeatures){
         if ( infeature->geometryType() != itPOINT)
             continue;
@@ -49,16 +51,25 @@ bool PointRasterCrossing::execute(ExecutionContext *ctx, SymbolTable &symTable)
         const geos::geom::Coordinate *crd = newFeature->geometry()->getCoordinate();
         if (!crd)
             continue;
-        Coordinate coord =  _doCoordTransform ? _outputFeatures->coordinateSystem()->coord2coord(_inputRaster->coordinateSystem(), *crd) : *crd;
+        newFeatures.push_back(newFeature);
+        xs.push_back(crd->x);
+        ys.push_back(crd->y);
+    }
+    quint32 count = newFeatures.size();
+    if ( count > 0) {
+        if ( _doCoordTransform)
+            _outputFeatures->coordinateSystem()->coord2coord(_inputRaster->coordinateSystem(), &xs[0], &ys[0], count);
+        _inputRaster->georeference()->coord2Pixel(&xs[0], &ys[0], count, &xs[0], &ys[0]);
+    }
 
-        Pixel pix = _inputRaster->georeference()->coord2Pixel(coord);
+    for(quint32 i = 0; i < count; ++i){
+        Pixel pix = Pixeld(xs[i], ys[i]);
         for(int z = 0; z < _inputRaster->size().zsize(); ++z){
             pix.z = z;
             double v = _inputRaster->pix2value(pix);
-            newFeature(_startColumn + z,QVariant(v));
+            newFeatures[i](_startColumn + z,QVariant(v));
 
         }
-        ++record;
     }
 
     if ( ctx != 0) {
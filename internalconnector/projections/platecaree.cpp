@@ -34,7 +34,40 @@ PlateCaree::~PlateCaree()
 
 Coordinate PlateCaree::ll2crd(const LatLon &ll) const
 {
-    return Coordinate(ll.lon(), ll.lat());
+    return Coordinate(ll.x * M_PI / 180.0, ll.y * M_PI / 180.0);
+}
+
+quint32 PlateCaree::latlon2coord(double *x, double *y, quint32 count, quint8 *status) const
+{
+    // linear in both directions, so the whole array is one scaled loop
+    double scale = _maxis * M_PI / 180.0;
+    quint32 converted = 0;
+    for(quint32 i = 0; i < count; ++i) {
+        bool ok = x[i] != rUNDEF && y[i] != rUNDEF;
+        double lat = std::max(-90.0, std::min(90.0, y[i]));
+        x[i] = ok ? (x[i] - _centralMeridian) * scale + _easting : rUNDEF;
+        y[i] = ok ? lat * scale + _northing : rUNDEF;
+        if ( status)
+            status[i] = ok;
+        converted += ok;
+    }
+    return converted;
+}
+
+quint32 PlateCaree::coord2latlon(double *x, double *y, quint32 count, quint8 *status) const
+{
+    double scale = 180.0 / (M_PI * _maxis);
+    quint32 converted = 0;
+    for(quint32 i = 0; i < count; ++i) {
+        double lat = (y[i] - _northing) * scale;
+        bool ok = x[i] != rUNDEF && y[i] != rUNDEF && std::abs(lat) <= 90;
+        x[i] = ok ? (x[i] - _easting) * scale + _centralMeridian : rUNDEF;
+        y[i] = ok ? lat : rUNDEF;
+        if ( status)
+            status[i] = ok;
+        converted += ok;
+    }
+    return converted;
 }
 
 LatLon PlateCaree::crd2ll(const Coordinate &crd) const
@@ -10,6 +10,10 @@ public:
     ~PlateCaree();
     Coordinate ll2crd(const LatLon&) const;
     LatLon crd2ll(const Coordinate&) const;
+    quint32 latlon2coord(double *x, double *y, quint32 count, quint8 *status=0) const;
+    quint32 coord2latlon(double *x, double *y, quint32 count, quint8 *status=0) const;
+    using ProjectionImplementationInternal::latlon2coord;
+    using ProjectionImplementationInternal::coord2latlon;
     static bool canUse(const Ilwis::Resource &) ;
     bool prepare(const QString &parms = "");
 };
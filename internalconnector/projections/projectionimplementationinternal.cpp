@@ -36,13 +36,10 @@ Coordinate ProjectionImplementationInternal::latlon2coord(const LatLon &ll) cons
 {
     if (_coordinateSystem->projection().isValid() && ll.isValid()) {
         LatLon pl(ll);
-        if (pl.lat() > M_PI_2)
-            pl.lat(Angle(M_PI_2, true));
-        else if (pl.lat() < -M_PI_2)
-            pl.lat(Angle(-M_PI_2, true));
-        pl.lon( pl.lon()-_centralMeridian);
+        pl.y = std::max(-90.0, std::min(90.0, pl.y));
+        pl.x -= _centralMeridian;
         Coordinate xy = ll2crd(pl);
-        if (xy != crdUNDEF)
+        if (xy == crdUNDEF)
             return crdUNDEF;
         Coordinate crd;
         crd.x = xy.x * _maxis  + _easting;
@@ -1,5 +1,6 @@
 #include <QString>
 #include <functional>
+#include <cmath>
 
 #include "kernel.h"
 #include "ilwis.h"
@@ -213,4 +214,57 @@ LatLon ProjectionImplementationProj4::coord2latlon(const Coordinate &crd) const
     return LatLon(Angle(y,true),Angle(x, true));
 }
 
+quint32 ProjectionImplementationProj4::transform(projPJ source, projPJ target, double *x, double *y, quint32 count, quint8 *status) const
+{
+    // proj4 passes over points that are HUGE_VAL and marks points with a transient error that way; any other error aborts the whole call
+    for(quint32 i = 0; i < count; ++i) {
+        if ( x[i] == rUNDEF || y[i] == rUNDEF)
+            x[i] = y[i] = HUGE_VAL;
+    }
+    int err = 0;
+    if ( source != 0 && target != 0)
+        err = pj_transform(source, target, count, 1, x, y, NULL);
+    bool failed = source == 0 || target == 0 || err != 0;
+    quint32 converted = 0;
+    for(quint32 i = 0; i < count; ++i) {
+        bool ok = !failed && x[i] != HUGE_VAL && y[i] != HUGE_VAL && std::isfinite(x[i]) && std::isfinite(y[i]);
+        if ( !ok)
+            x[i] = y[i] = rUNDEF;
+        if ( status)
+            status[i] = ok;
+        converted += ok;
+    }
+    return converted;
+}
 
+quint32 ProjectionImplementationProj4::latlon2coord(double *x, double *y, quint32 count, quint8 *status) const
+{
+    for(quint32 i = 0; i < count; ++i) {
+        if ( x[i] != rUNDEF && y[i] != rUNDEF) {
+            x[i] *= DEG_TO_RAD;
+            y[i] *= DEG_TO_RAD;
+        }
+    }
+    quint32 converted = transform(_pjLatlon, _pjBase, x, y, count, status);
+    if ( _outputIsLatLon) {
+        for(quint32 i = 0; i < count; ++i) {
+            if ( x[i] != rUNDEF) {
+                x[i] *= RAD_TO_DEG;
+                y[i] *= RAD_TO_DEG;
+            }
+        }
+    }
+    return converted;
+}
+
+quint32 ProjectionImplementationProj4::coord2latlon(double *x, double *y, quint32 count, quint8 *status) const
+{
+    quint32 converted = transform(_pjBase, _pjLatlon, x, y, count, status);
+    for(quint32 i = 0; i < count; ++i) {
+        if ( x[i] != rUNDEF) {
+            x[i] *= RAD_TO_DEG;
+            y[i] *= RAD_TO_DEG;
+        }
+    }
+    return converted;
+}
@@ -10,6 +10,8 @@ public:
     ~ProjectionImplementationProj4();
     Coordinate latlon2coord(const LatLon&) const;
     LatLon coord2latlon(const Coordinate&) const;
+    quint32 latlon2coord(double *x, double *y, quint32 count, quint8 *status=0) const;
+    quint32 coord2latlon(double *x, double *y, quint32 count, quint8 *status=0) const;
     static bool canUse(const Ilwis::Resource &) { return true;}
     static ProjectionImplementation *create(const Ilwis::Resource &resource);
      bool compute() { return true; }
@@ -18,6 +20,8 @@ public:
      bool prepare(const QString& parms="");
      QString toProj4() const;
 private:
+    quint32 transform(projPJ source, projPJ target, double *x, double *y, quint32 count, quint8 *status) const;
+
     QString _targetDef;
     projPJ  _pjLatlon;
     projPJ  _pjBase;
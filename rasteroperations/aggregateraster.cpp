@@ -1,5 +1,8 @@
 #include <functional>
 #include <future>
+#include <algorithm>
+#include <limits>
+#include <cmath>
 #include "kernel.h"
 #include "raster.h"
 #include "symboltable.h"
@@ -26,36 +29,219 @@ AggregateRaster::AggregateRaster(quint64 metaid, const Ilwis::OperationExpressio
 {
 }
 
+GroupReducer::GroupReducer(NumericStatistics::PropertySets method, quint32 inputColumns, quint32 groupColumns) :
+    _method(method),
+    _inputColumns(inputColumns),
+    _groupColumns(groupColumns)
+{
+    _groups = (_inputColumns + _groupColumns - 1) / _groupColumns;
+    _first.resize(_groups);
+    _second.resize(_groups);
+    _counts.resize(_groups);
+    if ( _method == NumericStatistics::pPREDOMINANT)
+        _frequencies.resize(_groups);
+    if ( _method == NumericStatistics::pMEDIAN)
+        _values.resize(_groups);
+    reset();
+}
+
+void GroupReducer::reset()
+{
+    double start = 0;
+    if ( _method == NumericStatistics::pMIN)
+        start = std::numeric_limits<double>::max();
+    else if ( _method == NumericStatistics::pMAX)
+        start = -std::numeric_limits<double>::max();
+    std::fill(_first.begin(), _first.end(), start);
+    std::fill(_second.begin(), _second.end(), 0);
+    std::fill(_counts.begin(), _counts.end(), 0);
+    for(auto& frequencies : _frequencies)
+        frequencies.clear();
+    for(auto& values : _values)
+        values.clear();
+}
+
+void GroupReducer::add(const double *row)
+{
+    for(quint32 group = 0; group < _groups; ++group) {
+        const double *first = row + group * _groupColumns;
+        const double *last = row + std::min(_inputColumns, (group + 1) * _groupColumns);
+        double& acc = _first[group];
+        quint64& count = _counts[group];
+        switch(_method) {
+        case NumericStatistics::pMIN:
+            for(const double *v = first; v != last; ++v) {
+                if ( !isNumericalUndef(*v)) {
+                    acc = std::min(acc, *v);
+                    ++count;
+                }
+            }
+            break;
+        case NumericStatistics::pMAX:
+            for(const double *v = first; v != last; ++v) {
+                if ( !isNumericalUndef(*v)) {
+                    acc = std::max(acc, *v);
+                    ++count;
+                }
+            }
+            break;
+        case NumericStatistics::pSTDEV:
+            for(const double *v = first; v != last; ++v) {
+                if ( !isNumericalUndef(*v)) { // Welford: one pass, no cancellation
+                    double delta = *v - acc;
+                    acc += delta / ++count;
+                    _second[group] += delta * (*v - acc);
+                }
+            }
+            break;
+        case NumericStatistics::pPREDOMINANT: {
+            // groups hold few distinct values; a short list that is searched from the last hit beats a hash map
+            auto& frequencies = _frequencies[group];
+            quint32 hit = 0;
+            for(const double *v = first; v != last; ++v) {
+                if ( isNumericalUndef(*v))
+                    continue;
+                if ( hit >= frequencies.size() || frequencies[hit].first != *v) {
+                    hit = 0;
+                    while(hit < frequencies.size() && frequencies[hit].first != *v)
+                        ++hit;
+                    if ( hit == frequencies.size())
+                        frequencies.push_back(std::pair<double, quint32>(*v, 0));
+                }
+                ++frequencies[hit].second;
+                ++count;
+            }
+            break;
+        }
+        case NumericStatistics::pMEDIAN:
+            for(const double *v = first; v != last; ++v) {
+                if ( !isNumericalUndef(*v))
+                    _values[group].push_back(*v);
+            }
+            count = _values[group].size();
+            break;
+        default: // sum, mean and count
+            for(const double *v = first; v != last; ++v) {
+                if ( !isNumericalUndef(*v)) {
+                    acc += *v;
+                    ++count;
+                }
+            }
+            break;
+        }
+    }
+}
+
+void GroupReducer::result(double *values)
+{
+    for(quint32 group = 0; group < _groups; ++group) {
+        quint64 count = _counts[group];
+        double& value = values[group];
+        if ( _method == NumericStatistics::pNETTOCOUNT) {
+            value = count;
+            continue;
+        }
+        if ( count == 0) {
+            value = rUNDEF;
+            continue;
+        }
+        switch(_method) {
+        case NumericStatistics::pMEAN:
+            value = _first[group] / count; break;
+        case NumericStatistics::pSTDEV:
+            value = count < 2 ? rUNDEF : std::sqrt(_second[group] / (count - 1)); break;
+        case NumericStatistics::pPREDOMINANT: {
+            // ties go to the smallest value, so the result does not depend on the order of the pixels
+            const auto& frequencies = _frequencies[group];
+            auto best = frequencies.begin();
+            for(auto iter = frequencies.begin(); iter != frequencies.end(); ++iter) {
+                if ( iter->second > best->second || (iter->second == best->second && iter->first < best->first))
+                    best = iter;
+            }
+            value = best->first;
+            break;
+        }
+        case NumericStatistics::pMEDIAN: { // the lower median, a value that occurs in the group
+            auto& groupValues = _values[group];
+            auto middle = groupValues.begin() + (groupValues.size() - 1) / 2;
+            std::nth_element(groupValues.begin(), middle, groupValues.end());
+            value = *middle;
+            break;
+        }
+        default: // sum, min and max
+            value = _first[group];
+            break;
+        }
+    }
+}
+
+quint32 GroupReducer::groups() const
+{
+    return _groups;
+}
+
+//-------------------------------------------------------
 bool AggregateRaster::execute(ExecutionContext *ctx, SymbolTable& symTable)
 {
     if (_prepState == sNOTPREPARED)
         if((_prepState = prepare(ctx,symTable)) != sPREPARED)
             return false;
 
+    IRasterCoverage inputRaster = _inputObj.as<RasterCoverage>();
     IRasterCoverage outputRaster = _outputObj.as<RasterCoverage>();
+    Size<> inputSize = inputRaster->size();
 
-    quint64 currentCount = 0;
-    BoxedAsyncFunc aggregateFun = [&](const BoundingBox& box) -> bool {
-        //Size sz = outputRaster->size();
+    // the input is read line by line and every line is reduced into the groups of its output line; when the geometry is kept,
+    // the output lines of one group share the same group values
+    BoxedStatisticsFunc aggregateFun = [&](const BoundingBox& box, NumericStatistics::Partial& markers) -> bool {
         PixelIterator iterOut(outputRaster, box);
-        BoundingBox inpBox(Pixel(box.min_corner().x,
-                                             box.min_corner().y * groupSize(1),
-                                             box.min_corner().z * groupSize(2)),
-                             Pixel((box.max_corner().x+1) * groupSize(0) - 1,
-                                             (box.max_corner().y + 1) * groupSize(1) - 1,
-                                             (box.max_corner().z + 1) * groupSize(2) - 1) );
-
-        BlockIterator blockIter(_inputObj.as<RasterCoverage>(),Size<>(groupSize(0),groupSize(1), groupSize(2)), inpBox);
-        NumericStatistics stats;
         PixelIterator iterEnd = iterOut.end();
-        while(iterOut != iterEnd) {
-            GridBlock& block = *blockIter;
-            stats.calculate(block.begin(), block.end(), _method);
-            double v = stats[_method];
-           *iterOut = v;
-            ++iterOut;
-            ++blockIter;
-            updateTranquilizer(currentCount++, 1000);
+        GroupReducer reducer(_method, inputSize.xsize(), groupSize(0));
+        std::vector<double> line(inputSize.xsize());
+        std::vector<double> groupValues(reducer.groups());
+        std::vector<double> result(outputRaster->size().xsize());
+        qint32 lastGroupY = iUNDEF, lastGroupZ = iUNDEF;
+        qint32 zmax = std::min((qint32)box.max_corner().z, (qint32)outputRaster->size().zsize() - 1);
+        for(qint32 z = box.min_corner().z; z <= zmax; ++z) {
+            for(qint32 y = box.min_corner().y; y <= box.max_corner().y && iterOut != iterEnd; ++y) {
+                qint32 groupY = _grouped ? y : y / groupSize(1);
+                qint32 groupZ = _grouped ? z : z / groupSize(2);
+                if ( groupY != lastGroupY || groupZ != lastGroupZ) {
+                    reducer.reset();
+                    qint32 zend = std::min((groupZ + 1) * groupSize(2), (quint32)inputSize.zsize());
+                    qint32 yend = std::min((groupY + 1) * groupSize(1), (quint32)inputSize.ysize());
+                    for(qint32 iz = groupZ * groupSize(2); iz < zend; ++iz) {
+                        for(qint32 iy = groupY * groupSize(1); iy < yend; ++iy) {
+                            readLine(inputRaster, iy, iz, line);
+                            reducer.add(&line[0]);
+                        }
+                    }
+                    reducer.result(&groupValues[0]);
+                    if ( _grouped)
+                        std::copy(groupValues.begin(), groupValues.begin() + std::min(groupValues.size(), result.size()), result.begin());
+                    else {
+                        for(quint32 x = 0; x < result.size(); ++x)
+                            result[x] = groupValues[x / groupSize(0)];
+                    }
+                    lastGroupY = groupY;
+                    lastGroupZ = groupZ;
+                }
+
+                const double *values = &result[box.min_corner().x];
+                qint64 todo = box.xlength();
+                while(todo > 0) {
+                    auto out = iterOut.span();
+                    qint64 cells = std::min(todo, (qint64)(out.second - out.first));
+                    if ( cells == 0)
+                        return false;
+                    std::copy(values, values + cells, out.first);
+                    std::for_each(out.first, out.first + cells, std::ref(markers));
+                    values += cells;
+                    todo -= cells;
+                    iterOut += cells;
+                }
+                trq().update(box.xlength());
+            }
         }
         return true;
     };
@@ -69,6 +255,22 @@ bool AggregateRaster::execute(ExecutionContext *ctx, SymbolTable& symTable)
     return res;
 }
 
+void AggregateRaster::readLine(const IRasterCoverage &raster, qint32 y, qint32 z, std::vector<double> &line) const
+{
+    PixelIterator iter(raster, BoundingBox(Pixel(0, y, z), Pixel(line.size() - 1, y, z)));
+    PixelIterator iterEnd = iter.end();
+    double *target = &line[0];
+    while(iter != iterEnd) {
+        auto run = iter.span();
+        qint64 cells = run.second - run.first;
+        if ( cells == 0)
+            break;
+        std::copy(run.first, run.second, target);
+        target += cells;
+        iter += cells;
+    }
+}
+
 NumericStatistics::PropertySets AggregateRaster::toMethod(const QString& nm) {
     QString mname = nm.toLower();
     if ( mname == "avg")
@@ -85,6 +287,8 @@ NumericStatistics::PropertySets AggregateRaster::toMethod(const QString& nm) {
         return NumericStatistics::pSTDEV;
     else if ( mname == "sum")
         return NumericStatistics::pSUM;
+    else if ( mname == "cnt")
+        return NumericStatistics::pNETTOCOUNT;
 
     return NumericStatistics::pLAST    ;
 }
@@ -189,7 +393,7 @@ quint64 AggregateRaster::createMetadata()
 
     OperationResource operation({"ilwis://operations/aggregateraster"});
     operation.setLongName("Spatial Aggregation of Raster coverage");
-    operation.setSyntax("aggregateraster(inputgridcoverage,!Avg|Max|Med|Min|Prd|Std|Sum, groupsize,changegeometry[,new georefname])");
+    operation.setSyntax("aggregateraster(inputgridcoverage,!Avg|Cnt|Max|Med|Min|Prd|Std|Sum, groupsize,changegeometry[,new georefname])");
     operation.setDescription(TR("generates a rastercoverage according to a aggregation method. The aggregation method determines how pixel values are used in the aggregation"));
     operation.setInParameterCount({4,5});
     operation.addInParameter(0,itRASTER , TR("input rastercoverage"),TR("input rastercoverage with any domain"));
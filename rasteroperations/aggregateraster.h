@@ -3,6 +3,35 @@
 
 namespace Ilwis {
 namespace RasterOperations {
+
+/*!
+ * \brief The GroupReducer class aggregates the groups of one output line while the input lines of those groups stream by
+ *
+ * Every input line of the groups is handed to add() once, as a contiguous row; result() then gives one value per group. Each method
+ * has its own streaming loop (sum, mean, count, min, max, a Welford stdev, a small value/count table for the predominant value); only
+ * the median keeps the values of a group and selects from them. Undefined values are skipped; a group without defined values is undefined.
+ */
+class GroupReducer {
+public:
+    GroupReducer(NumericStatistics::PropertySets method, quint32 inputColumns, quint32 groupColumns);
+
+    void reset();
+    void add(const double *row);
+    void result(double *values);
+    quint32 groups() const;
+
+private:
+    NumericStatistics::PropertySets _method;
+    quint32 _inputColumns;
+    quint32 _groupColumns;
+    quint32 _groups;
+    std::vector<double> _first; // sum, minimum, maximum or mean, depending on the method
+    std::vector<double> _second; // sum of squared differences for the stdev
+    std::vector<quint64> _counts;
+    std::vector<std::vector<std::pair<double, quint32>>> _frequencies;
+    std::vector<std::vector<double>> _values;
+};
+
 class AggregateRaster : public OperationImplementation
 {
 public:
@@ -26,6 +55,7 @@ private:
     std::vector<quint32> _groupSize = {1,1,1};
 
     NumericStatistics::PropertySets toMethod(const QString &nm);
+    void readLine(const IRasterCoverage& raster, qint32 y, qint32 z, std::vector<double>& line) const;
 };
 }
 }
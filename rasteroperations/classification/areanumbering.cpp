@@ -38,35 +38,29 @@ bool AreaNumbering::execute(ExecutionContext *ctx, SymbolTable& symTable)
         if((_prepState = prepare(ctx,symTable)) != sPREPARED)
             return false;
 
+    IRasterCoverage inputRaster = _inputObj.as<RasterCoverage>();
     IRasterCoverage outputRaster = _outputObj.as<RasterCoverage>();
-    AreaNumberer numberer(outputRaster->size().xsize(),_connectivity);
-    quint64 currentCount = 0;
-
-    BoxedAsyncFunc aggregateFun = [&](const BoundingBox& box) -> bool {
-        //pass one
-        PixelIterator iterOut(outputRaster, box);
-        PixelIterator iterIn(_inputObj.as<RasterCoverage>());
-        PixelIterator iterEnd = iterOut.end();
-        while(iterOut != iterEnd) {
-            double v = numberer.value(iterIn) ;
-           *iterOut = v;
-            ++iterOut;
-            ++iterIn;
-            updateTranquilizer(currentCount++, 1000);
-        }
-        //pass two
-        for(auto iterPass2 : numberer.pass2Entries()) {
-            for(double& v : _outputObj.as<RasterCoverage>()){
-                if ( v == iterPass2.first){
-                    v = iterPass2.second;
-                }
-            }
-        }
+    std::vector<BoundingBox> tiles;
+    int cores = OperationHelperRaster::subdivideTasks(ctx, outputRaster, BoundingBox(), tiles);
+    if ( cores == iUNDEF)
+        return false;
 
+    AreaNumberer numberer(outputRaster->size().xsize(), _connectivity, tiles);
+    BoxedAsyncFunc labelFun = [&](const BoundingBox& box) -> bool {
+        if (!numberer.label(inputRaster, outputRaster, box))
+            return false;
+        trq().update(box.xlength() * box.ylength());
         return true;
     };
-    ctx->_threaded = false; // operation can not be run in parallel
-    bool res = OperationHelperRaster::execute(ctx, aggregateFun, outputRaster);
+    BoxedAsyncFunc relabelFun = [&](const BoundingBox& box) -> bool {
+        return numberer.relabel(outputRaster, box);
+    };
+
+    bool res = tilescheduler()->execute(tiles, cores, labelFun, ctx);
+    if ( res) {
+        numberer.merge();
+        res = tilescheduler()->execute(tiles, cores, relabelFun, ctx);
+    }
 
     INamedIdDomain iddom = outputRaster->datadef().domain<>().as<NamedIdDomain>();
     NamedIdentifierRange range;
@@ -149,68 +143,178 @@ quint64 AreaNumbering::createMetadata()
 
 
 //-----------------------------------------------------------
-AreaNumberer::AreaNumberer(quint32 xsize, quint8 connectivity) : _connectivity(connectivity)
+namespace {
+const quint32 noLabel = std::numeric_limits<quint32>::max();
+}
+
+AreaNumberer::AreaNumberer(quint32 xsize, quint8 connectivity, const std::vector<BoundingBox> &tiles) :
+    _xsize(xsize),
+    _connectivity(connectivity)
 {
-    _neighboursIn.resize(xsize);
-    _neighboursOut.resize(xsize);
+    _tiles.resize(tiles.size());
+    for(quint32 i = 0; i < tiles.size(); ++i)
+        _tileIndex[tiles[i].min_corner().y] = i;
 }
 
-std::map<int, int> AreaNumberer::pass2Entries()
+AreaNumberer::Tile &AreaNumberer::tile(const BoundingBox &box)
 {
-    return _pass2Changes;
+    auto iter = _tileIndex.find(box.min_corner().y);
+    if ( iter == _tileIndex.end())
+        throw ErrorObject(TR("Area numbering got a tile it did not expect"));
+    return _tiles[iter->second];
 }
 
-quint32 AreaNumberer::value(const PixelIterator &inIter)
+bool AreaNumberer::label(const IRasterCoverage &inputRaster, const IRasterCoverage &outputRaster, const BoundingBox &box)
 {
-    if ( _connectivity == 4) {
-        return do4connected(inIter);
+    Tile& tile = this->tile(box);
+    std::vector<quint32>& parents = tile._parents;
+    BoundingBox lines(Pixel(0, box.min_corner().y, 0), Pixel(_xsize - 1, box.max_corner().y, 0));
+    PixelIterator iterIn(inputRaster, lines);
+    PixelIterator iterOut(outputRaster, lines);
+    PixelIterator iterEnd = iterOut.end();
+
+    std::vector<double> previousIn(_xsize, rUNDEF), currentIn(_xsize, rUNDEF);
+    std::vector<quint32> previousLabels(_xsize, noLabel), currentLabels(_xsize, noLabel);
+    quint64 cell = 0;
+    bool firstLine = true;
+    while(iterOut != iterEnd) {
+        auto in = iterIn.span();
+        auto out = iterOut.span();
+        int cells = std::min(in.second - in.first, out.second - out.first);
+        if ( cells == 0)
+            break;
+        for(int i = 0; i < cells; ++i, ++cell) {
+            quint32 x = cell % _xsize;
+            if ( x == 0 && cell > 0) {
+                if ( firstLine) {
+                    tile._firstIn = currentIn;
+                    tile._firstLabels = currentLabels;
+                    firstLine = false;
+                }
+                std::swap(previousIn, currentIn);
+                std::swap(previousLabels, currentLabels);
+            }
+            double v = in.first[i];
+            quint32 label = noLabel;
+            if ( !isNumericalUndef(v)) {
+                // the neighbours that were already visited: the left one and the line above (including its diagonals for 8 connectivity)
+                if ( x > 0 && currentIn[x - 1] == v)
+                    label = currentLabels[x - 1];
+                if ( cell >= _xsize) {
+                    quint32 from = _connectivity == 8 && x > 0 ? x - 1 : x;
+                    quint32 to = _connectivity == 8 && x < _xsize - 1 ? x + 1 : x;
+                    for(quint32 nx = from; nx <= to; ++nx) {
+                        if ( previousIn[nx] != v)
+                            continue;
+                        if ( label == noLabel)
+                            label = previousLabels[nx];
+                        else
+                            join(parents, label, previousLabels[nx]);
+                    }
+                }
+                if ( label == noLabel) {
+                    label = parents.size();
+                    parents.push_back(label);
+                }
+            } else
+                v = rUNDEF;
+            currentIn[x] = v;
+            currentLabels[x] = label;
+            out.first[i] = label == noLabel ? rUNDEF : label;
+        }
+        iterIn += cells;
+        iterOut += cells;
+    }
+    if ( firstLine) {
+        tile._firstIn = currentIn;
+        tile._firstLabels = currentLabels;
     }
-    return 0;
+    tile._lastIn = currentIn;
+    tile._lastLabels = currentLabels;
+
+    return true;
 }
 
-quint32 AreaNumberer::lastid() const
+quint32 AreaNumberer::merge()
 {
+    quint32 total = 0;
+    for(Tile& tile : _tiles) {
+        tile._offset = total;
+        total += tile._parents.size();
+    }
+    std::vector<quint32> parents(total);
+    for(Tile& tile : _tiles) {
+        for(quint32 i = 0; i < tile._parents.size(); ++i)
+            parents[tile._offset + i] = tile._offset + find(tile._parents, i);
+        std::vector<quint32>().swap(tile._parents);
+    }
+    // areas that continue over a tile border
+    for(quint32 t = 1; t < _tiles.size(); ++t) {
+        const Tile& upper = _tiles[t - 1];
+        const Tile& lower = _tiles[t];
+        if ( upper._lastLabels.size() != _xsize || lower._firstLabels.size() != _xsize)
+            continue;
+        for(quint32 x = 0; x < _xsize; ++x) {
+            if ( lower._firstLabels[x] == noLabel)
+                continue;
+            quint32 from = _connectivity == 8 && x > 0 ? x - 1 : x;
+            quint32 to = _connectivity == 8 && x < _xsize - 1 ? x + 1 : x;
+            for(quint32 nx = from; nx <= to; ++nx) {
+                if ( upper._lastLabels[nx] != noLabel && upper._lastIn[nx] == lower._firstIn[x])
+                    join(parents, lower._offset + lower._firstLabels[x], upper._offset + upper._lastLabels[nx]);
+            }
+        }
+    }
+    // the root of a set is its smallest label, so numbering in label order gives the areas consecutive numbers in scan order
+    _areas.resize(total);
+    _currentId = 0;
+    for(quint32 i = 0; i < total; ++i) {
+        quint32 root = find(parents, i);
+        _areas[i] = root == i ? _currentId++ : _areas[root];
+    }
     return _currentId;
 }
 
-double AreaNumberer::do4connected(const PixelIterator &in)  {
-    qint32 x = in.position().x;
-    qint32 y = in.position().y;
-    double v = *in;
-    double out = rUNDEF;
-
-    if ( x == 0 && y == 0) {
-        out = _currentId;
-        _neighboursIn[x] = v;
-        _neighboursOut[x] = _currentId++;
-    } else if ( y == 0) {
-        if ( v == _neighboursIn[x-1] ) {
-            out = _neighboursOut[x-1];
-            _neighboursIn[x] = v;
-            _neighboursOut[x] = _neighboursOut[x-1];
-        } else {
-            out = _currentId;
-            _neighboursIn[x] = v;
-            _neighboursOut[x] = _currentId++;
-        }
-    } else if ( v == _neighboursIn[x] ){
-        out = _neighboursOut[x];
-        _neighboursIn[x] = v;
-        if ( x > 0 && y > 0 &&
-             v == _neighboursIn[x - 1] &&
-             _neighboursOut[x] != _neighboursOut[x-1]){
-            _pass2Changes[_neighboursOut[x-1]] = _neighboursOut[x];
+bool AreaNumberer::relabel(const IRasterCoverage &outputRaster, const BoundingBox &box)
+{
+    const Tile& tile = this->tile(box);
+    BoundingBox lines(Pixel(0, box.min_corner().y, 0), Pixel(_xsize - 1, box.max_corner().y, 0));
+    PixelIterator iterOut(outputRaster, lines);
+    PixelIterator iterEnd = iterOut.end();
+    while(iterOut != iterEnd) {
+        auto out = iterOut.span();
+        int cells = out.second - out.first;
+        if ( cells == 0)
+            break;
+        for(double *v = out.first; v != out.second; ++v) {
+            if ( *v != rUNDEF)
+                *v = _areas[tile._offset + (quint32)*v];
         }
-    } else if ( x > 0 && v == _neighboursIn[x - 1]) {
-        out = _neighboursOut[x - 1];
-        _neighboursIn[x] = v;
-        _neighboursOut[x] = _neighboursOut[x - 1];
-    } else {
-        out = _currentId;
-        _neighboursIn[x] = v;
-        _neighboursOut[x] = _currentId++;
+        iterOut += cells;
     }
-    return out;
+    return true;
+}
+
+quint32 AreaNumberer::lastid() const
+{
+    return _currentId;
 }
 
+quint32 AreaNumberer::find(std::vector<quint32> &parents, quint32 label)
+{
+    while(parents[label] != label) {
+        parents[label] = parents[parents[label]]; // path halving
+        label = parents[label];
+    }
+    return label;
+}
 
+void AreaNumberer::join(std::vector<quint32> &parents, quint32 label1, quint32 label2)
+{
+    label1 = find(parents, label1);
+    label2 = find(parents, label2);
+    if ( label1 < label2)
+        parents[label2] = label1;
+    else if ( label2 < label1)
+        parents[label1] = label2;
+}
@@ -25,22 +25,43 @@ private:
 
 };
 
+/*!
+ * \brief The AreaNumberer class labels the connected areas of a raster with a union-find
+ *
+ * The raster is cut in tiles of whole lines that are labelled independently (label()); equivalent labels within a tile are joined in
+ * the tile's own union-find. merge() joins the labels that meet along the tile borders and flattens everything to consecutive area
+ * numbers, after which relabel() writes those into the output. Only label() and relabel() run in parallel; a tile is only ever
+ * touched by one thread.
+ */
 class AreaNumberer {
 public:
-    AreaNumberer(quint32 xsize, quint8 connectivity);
-    std::map<int,int> pass2Entries();
-    quint32 value(const Ilwis::PixelIterator &inIter);
+    AreaNumberer(quint32 xsize, quint8 connectivity, const std::vector<BoundingBox>& tiles);
+    bool label(const IRasterCoverage& inputRaster, const IRasterCoverage& outputRaster, const BoundingBox& box);
+    quint32 merge();
+    bool relabel(const IRasterCoverage& outputRaster, const BoundingBox& box);
 
     quint32 lastid() const;
 
 private:
+    struct Tile {
+        std::vector<quint32> _parents;
+        std::vector<double> _firstIn;
+        std::vector<quint32> _firstLabels;
+        std::vector<double> _lastIn;
+        std::vector<quint32> _lastLabels;
+        quint32 _offset = 0;
+    };
+
+    static quint32 find(std::vector<quint32>& parents, quint32 label);
+    static void join(std::vector<quint32>& parents, quint32 label1, quint32 label2);
+    Tile& tile(const BoundingBox& box);
+
+    quint32 _xsize;
     quint8 _connectivity;
     quint32 _currentId = 0;
-    std::vector<double> _neighboursIn;
-    std::vector<double> _neighboursOut;
-    std::map<int,int> _pass2Changes;
-    double do4connected(const Ilwis::PixelIterator &in);
-
+    std::map<qint32, quint32> _tileIndex;
+    std::vector<Tile> _tiles;
+    std::vector<quint32> _areas;
 };
 }
 }
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cmath>
 #include <unordered_map>
 #include "kernel.h"
 #include "ilwisdata.h"
@@ -6,6 +8,7 @@
 #include "location.h"
 #include "raster.h"
 #include "pixeliterator.h"
+#include "bandvectoriterator.h"
 #include "classification/samplestatistics.h"
 #include "classification/sampleset.h"
 #include "classifier.h"
@@ -13,92 +16,201 @@
 using namespace Ilwis;
 using namespace RasterOperations;
 
+namespace {
+const quint32 BLOCKPIXELS = 256;
+}
+
 Classifier::Classifier(const SampleSet &sampleset) : _sampleset(sampleset)
 {
 }
 
+bool Classifier::classify(BandVectorIterator &iterIn, PixelIterator &iterOut) const
+{
+    if ( iterIn.bands() != _bands)
+        return ERROR2(ERR_ILLEGAL_VALUE_2, TR("number of bands"), QString::number(iterIn.bands()));
+
+    std::vector<double> pixels(BLOCKPIXELS * _bands);
+    PixelIterator iterEnd = iterOut.end();
+    while( iterOut != iterEnd) {
+        auto out = iterOut.span();
+        quint32 count = std::min<qint64>(BLOCKPIXELS, out.second - out.first);
+        if ( count == 0)
+            break;
+        for(quint32 p = 0; p < count; ++p) {
+            std::copy(*iterIn, *iterIn + _bands, pixels.begin() + p * _bands);
+            ++iterIn;
+        }
+        if ( _classRaws.size() == 0)
+            std::fill(out.first, out.first + count, iUNDEF);
+        else
+            classifyBlock(pixels.data(), count, out.first);
+        iterOut += count;
+    }
+    return true;
+}
+
+bool Classifier::prepareClasses(bool needsSpread, bool orderBySpread)
+{
+    const UPSampleStatistics& stats = sampleset().statistics();
+    _bands = sampleset().sampleRasterSet()->size().zsize();
+    _classRaws.clear();
+    std::map<Raw, double> stdProducts;
+    for(auto item : sampleset().thematicDomain()){
+        Raw raw = item->raw();
+        double product = 1;
+        for(quint32 band = 0; band < _bands; ++band){
+            product *= stats->at(raw, band, SampleCell::mSTANDARDDEV);
+            double mean = stats->at(raw, band, SampleCell::mMEAN);
+            if ( needsSpread && mean > 0 && product < EPS10){
+                return ERROR3(ERR_NO_INITIALIZED_3, "item",sampleset().name(), TR("needs more samples"));
+            }
+        }
+        stdProducts[raw] = product;
+        _classRaws.push_back(raw);
+    }
+    if ( orderBySpread) // the tightest classes are tried first
+        std::stable_sort(_classRaws.begin(), _classRaws.end(), [&](Raw raw1, Raw raw2) { return stdProducts[raw1] < stdProducts[raw2]; });
+
+    _means.resize(_bands * _classRaws.size());
+    _stdevs.resize(_bands * _classRaws.size());
+    for(quint32 c = 0; c < _classRaws.size(); ++c) {
+        for(quint32 band = 0; band < _bands; ++band){
+            _means[at(band, c)] = stats->at(_classRaws[c], band, SampleCell::mMEAN);
+            _stdevs[at(band, c)] = stats->at(_classRaws[c], band, SampleCell::mSTANDARDDEV);
+        }
+    }
+    return true;
+}
+
 //-------------------------------------------------------------------
 BoxClassifier::BoxClassifier(double widenFactor, const SampleSet &sampleset) : Classifier(sampleset), _widenFactor(widenFactor){
 
 }
 
-bool BoxClassifier::classify(PixelIterator &iterIn, PixelIterator &iterOut) const
+void BoxClassifier::classifyBlock(const double *pixels, quint32 count, double *classes) const
 {
-    Raw currentClass, raw;
-    PixelIterator iterEnd = iterOut.end();
-    std::vector<double> zcolumn(sampleset().sampleRasterSet()->size().zsize(), rUNDEF);
-    while( iterOut != iterEnd)    {
-        for(auto item : sampleset().thematicDomain() ){
-            raw = iUNDEF;
-            currentClass = _classSequence.at(item->raw());
-            bool classFound = true;
-
-            for(double& v : zcolumn){
-                v = *iterIn;
-                ++iterIn;
-            }
-            for(int band = 0; band < zcolumn.size(); ++band){
-                classFound = classFound &&
-                        (zcolumn[band] < _boxMax.at((quint32)currentClass).at(band) &&
-                         zcolumn[band] > _boxMin.at((quint32)currentClass).at(band));
-                if (!classFound)
-                    break;
-            }
-            if ( classFound)  {
-                raw = currentClass;
+    quint32 nclasses = _classRaws.size();
+    std::vector<quint8> inside(nclasses);
+    for(quint32 p = 0; p < count; ++p) {
+        const double *values = pixels + p * _bands;
+        std::fill(inside.begin(), inside.end(), 1);
+        for(quint32 band = 0; band < _bands; ++band) {
+            double v = values[band];
+            const double *low = &_boxMin[at(band, 0)];
+            const double *high = &_boxMax[at(band, 0)];
+            for(quint32 c = 0; c < nclasses; ++c)
+                inside[c] &= (v > low[c]) & (v < high[c]);
+        }
+        classes[p] = iUNDEF;
+        for(quint32 c = 0; c < nclasses; ++c) {
+            if ( inside[c]) {
+                classes[p] = _classRaws[c];
                 break;
             }
         }
-        *iterOut = raw;
-        ++iterOut;
     }
-    return true;
 }
 
 bool BoxClassifier::prepare()
 {
-    std::map<Raw, double> stdProducts;
-    for(auto item : sampleset().thematicDomain())
-        stdProducts[item->raw()] = 1; //std::numeric_limits<double>::max();
-    stdProducts[iUNDEF] = 1; //std::numeric_limits<double>::max();;
+    if (!prepareClasses(true, true))
+        return false;
 
+    _boxMax.resize(_means.size());
+    _boxMin.resize(_means.size());
+    for(quint32 i = 0; i < _means.size(); ++i) {
+        _boxMax[i] = _means[i] + _widenFactor * _stdevs[i];
+        _boxMin[i] = _means[i] - _widenFactor * _stdevs[i];
+    }
+    return true;
+}
 
-    Raw maxRaw = rUNDEF;
-    for(auto item : sampleset().thematicDomain()){
-        Raw raw = item->raw();
-        maxRaw = Ilwis::max(raw, maxRaw);
-        for(int band = 0; band < sampleset().sampleRasterSet()->size().zsize(); ++band){
-            stdProducts[raw] *= sampleset().statistics()->at(raw,band, SampleCell::mSTANDARDDEV);
-            double mean = sampleset().statistics()->at(raw,band, SampleCell::mMEAN);
-            if ( mean > 0 && stdProducts[raw] < EPS10){
-                return ERROR3(ERR_NO_INITIALIZED_3, "item",sampleset().name(), TR("needs more samples"));
+//-------------------------------------------------------------------
+MinDistClassifier::MinDistClassifier(double threshold, const SampleSet &sampleset) : Classifier(sampleset), _threshold(threshold)
+{
+}
+
+bool MinDistClassifier::prepare()
+{
+    return prepareClasses(false);
+}
+
+void MinDistClassifier::classifyBlock(const double *pixels, quint32 count, double *classes) const
+{
+    quint32 nclasses = _classRaws.size();
+    double maxDistance = _threshold == rUNDEF ? rUNDEF : _threshold * _threshold;
+    std::vector<double> distances(nclasses);
+    for(quint32 p = 0; p < count; ++p) {
+        const double *values = pixels + p * _bands;
+        classes[p] = iUNDEF;
+        if ( std::any_of(values, values + _bands, [](double v) { return v == rUNDEF; }))
+            continue;
+
+        std::fill(distances.begin(), distances.end(), 0);
+        for(quint32 band = 0; band < _bands; ++band) {
+            double v = values[band];
+            const double *mean = &_means[at(band, 0)];
+            for(quint32 c = 0; c < nclasses; ++c) {
+                double d = v - mean[c];
+                distances[c] += d * d;
             }
         }
+        quint32 nearest = std::min_element(distances.begin(), distances.end()) - distances.begin();
+        if ( maxDistance == rUNDEF || distances[nearest] <= maxDistance)
+            classes[p] = _classRaws[nearest];
     }
-    _classSequence.resize(maxRaw + 1);
-    _boxMax.resize(maxRaw + 1);
-    _boxMin.resize(maxRaw + 1);
-    Raw smallestClass;
-    stdProducts[iUNDEF] = std::numeric_limits<double>::max();
-    for(auto item1 : sampleset().thematicDomain()) {
-        smallestClass = iUNDEF;
-        for(auto item2 : sampleset().thematicDomain()){
-            if ( stdProducts[item2->raw()] < stdProducts[smallestClass]) {
-                smallestClass = item2->raw();
-            }
+}
+
+//-------------------------------------------------------------------
+MaxLikelihoodClassifier::MaxLikelihoodClassifier(double threshold, const SampleSet &sampleset) : Classifier(sampleset), _threshold(threshold)
+{
+}
+
+bool MaxLikelihoodClassifier::prepare()
+{
+    if (!prepareClasses(true))
+        return false;
+
+    _inverseStdevs.resize(_stdevs.size());
+    _logDeterminants.assign(_classRaws.size(), 0);
+    for(quint32 c = 0; c < _classRaws.size(); ++c) {
+        for(quint32 band = 0; band < _bands; ++band){
+            double stdev = std::max(_stdevs[at(band, c)], EPS10);
+            _inverseStdevs[at(band, c)] = 1.0 / stdev;
+            _logDeterminants[c] += 2 * std::log(stdev);
         }
-        int raw = item1->raw();
-        _classSequence[(quint32)raw] = smallestClass;
-        stdProducts[smallestClass] = std::numeric_limits<double>::max();
     }
-    for(auto item : sampleset().thematicDomain()) {
-        for(int band = 0; band < sampleset().sampleRasterSet()->size().zsize(); ++band){
-            double std = sampleset().statistics()->at(item->raw(),band, SampleCell::mSTANDARDDEV);
-            double mean = sampleset().statistics()->at(item->raw(),band, SampleCell::mMEAN);
+    return true;
+}
 
-            _boxMax[(quint32)item->raw()].push_back( mean + _widenFactor * std);
-            _boxMin[(quint32)item->raw()].push_back(mean - _widenFactor * std);
+void MaxLikelihoodClassifier::classifyBlock(const double *pixels, quint32 count, double *classes) const
+{
+    // the class with the highest likelihood has the smallest sum of its log determinant and the squared (mahalanobis) distance;
+    // the threshold applies to the distance only
+    quint32 nclasses = _classRaws.size();
+    double maxDistance = _threshold == rUNDEF ? rUNDEF : _threshold * _threshold;
+    std::vector<double> distances(nclasses);
+    std::vector<double> scores(nclasses);
+    for(quint32 p = 0; p < count; ++p) {
+        const double *values = pixels + p * _bands;
+        classes[p] = iUNDEF;
+        if ( std::any_of(values, values + _bands, [](double v) { return v == rUNDEF; }))
+            continue;
+
+        std::fill(distances.begin(), distances.end(), 0);
+        for(quint32 band = 0; band < _bands; ++band) {
+            double v = values[band];
+            const double *mean = &_means[at(band, 0)];
+            const double *inverse = &_inverseStdevs[at(band, 0)];
+            for(quint32 c = 0; c < nclasses; ++c) {
+                double z = (v - mean[c]) * inverse[c];
+                distances[c] += z * z;
+            }
         }
+        for(quint32 c = 0; c < nclasses; ++c)
+            scores[c] = distances[c] + _logDeterminants[c];
+        quint32 best = std::min_element(scores.begin(), scores.end()) - scores.begin();
+        if ( maxDistance == rUNDEF || distances[best] <= maxDistance)
+            classes[p] = _classRaws[best];
     }
-    return true;
 }
@@ -6,15 +6,31 @@ namespace Ilwis {
 class SampleSet;
 
 namespace RasterOperations {
+/*!
+ * \brief The Classifier class is the base of the multi spectral classifiers
+ *
+ * classify() reads the pixels in blocks and hands every block to classifyBlock() of the actual classifier. The classifiers keep their
+ * class parameters band by band, with the values of all classes for one band next to each other, so one pixel is tested against all
+ * classes in straight loops over the classes that the compiler can vectorize.
+ */
 class Classifier
 {
 public:
     Classifier(const Ilwis::SampleSet &sampleset);
-    virtual bool classify(PixelIterator& iter, Ilwis::PixelIterator &iterOut) const = 0;
+    virtual ~Classifier() {}
+    bool classify(BandVectorIterator& iter, Ilwis::PixelIterator &iterOut) const;
     virtual bool prepare() = 0;
 
 protected:
     const SampleSet& sampleset() const { return _sampleset; }
+    virtual void classifyBlock(const double *pixels, quint32 count, double *classes) const = 0;
+    bool prepareClasses(bool needsSpread, bool orderBySpread=false);
+    quint32 at(quint32 band, quint32 classIndex) const { return band * _classRaws.size() + classIndex; }
+
+    quint32 _bands = 0;
+    std::vector<Raw> _classRaws;
+    std::vector<double> _means;
+    std::vector<double> _stdevs;
 
 private:
     const SampleSet& _sampleset;
@@ -24,17 +40,46 @@ class BoxClassifier : public Classifier{
 public:
     BoxClassifier(double factor, const SampleSet& sampleset);
 
-    bool classify(PixelIterator& iter, Ilwis::PixelIterator &iterOut) const;
     bool prepare();
-private:
 
+private:
+    void classifyBlock(const double *pixels, quint32 count, double *classes) const;
 
-    std::vector<std::vector<double>> _boxMax;
-    std::vector<std::vector<double>> _boxMin;
-    std::vector<Raw> _classSequence;
+    std::vector<double> _boxMax;
+    std::vector<double> _boxMin;
     double _widenFactor;
 
 };
+
+class MinDistClassifier : public Classifier{
+public:
+    MinDistClassifier(double threshold, const SampleSet& sampleset);
+
+    bool prepare();
+
+private:
+    void classifyBlock(const double *pixels, quint32 count, double *classes) const;
+
+    double _threshold;
+};
+
+/*!
+ * \brief The MaxLikelihoodClassifier class assigns a pixel to the class with the highest likelihood, assuming normally distributed
+ * and uncorrelated bands per class (the sample statistics hold means and standard deviations per band, no covariances)
+ */
+class MaxLikelihoodClassifier : public Classifier{
+public:
+    MaxLikelihoodClassifier(double threshold, const SampleSet& sampleset);
+
+    bool prepare();
+
+private:
+    void classifyBlock(const double *pixels, quint32 count, double *classes) const;
+
+    std::vector<double> _inverseStdevs;
+    std::vector<double> _logDeterminants;
+    double _threshold;
+};
 }
 }
 
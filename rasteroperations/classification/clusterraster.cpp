@@ -14,6 +14,7 @@
 #include "ilwisoperation.h"
 #include "operationhelpergrid.h"
 #include "geometryhelper.h"
+#include "bandvectoriterator.h"
 #include "clusterraster.h"
 
 using namespace Ilwis;
@@ -40,11 +41,12 @@ bool ClusterRaster::execute(ExecutionContext *ctx, SymbolTable &symTable)
     OperationHelperRaster::initialize(_outputRaster, indexLookup, itCOORDSYSTEM | itRASTERSIZE | itGEOREF);
     indexLookup->datadefRef() = DataDefinition(IDomain("count"));
 
-    PixelIterator iterIn(_inputRaster, BoundingBox(),PixelIterator::fZXY);
+    BandVectorIterator iterIn(_inputRaster);
     for(auto& value : indexLookup){
-        quint32 index = getFSIndex(iterIn);
+        quint32 index = getFSIndex(*iterIn, iterIn.bands());
         _histbands[index]._count++;
         value = index;
+        ++iterIn;
     }
 
     /* check actual number of combinations in combined histogram
@@ -185,23 +187,19 @@ int ClusterRaster::clusterCalculation(long clusterCombinations, long total,std::
     return newClusters;
 }
 
-long ClusterRaster::getFSIndex(PixelIterator& iterIn) {
+long ClusterRaster::getFSIndex(const double *values, quint32 bands) {
 
     long index = 0;
-    do{
-        BoundRange& br = _abrLookup[iterIn.position().z];
-        double val = *iterIn;
+    for(quint32 band = 0; band < bands; ++band) {
+        BoundRange& br = _abrLookup[band];
+        double val = values[band];
         // taking the 1% range needs check for values in the 1% range
         if (val < br.bottom) val = br.bottom;
         if (val > br.top) val = br.top;
 
         double ratio = (val - br.bottom) / (br.top - br.bottom);
         int subindex = (long) (ratio * _reducedValueSpread);
-        index += (subindex) << (_indexShift * iterIn.position().z);
-        ++iterIn;
-    } while(!iterIn.xchanged());
-    if ( index != 0){
-        qDebug() << "stop";
+        index += (subindex) << (_indexShift * band);
     }
     return index;
 }
@@ -72,7 +72,7 @@ private:
 
     void initFeatureSpaceHistogram(int noOfbands);
     void initStretchLookup();
-    long getFSIndex(PixelIterator &iterIn);
+    long getFSIndex(const double *values, quint32 bands);
     int clusterCalculation(long clusterCombinations, long total,std::vector<ClusterRecord>& newClusterSet);
     void initClusterSet(long total, long clusterCombinations, std::vector<ClusterRecord>& newClusterSet);
 
@@ -7,6 +7,7 @@
 #include "thematicitem.h"
 #include "symboltable.h"
 #include "ilwisoperation.h"
+#include "bandvectoriterator.h"
 #include "classification/sampleset.h"
 #include "classifier.h"
 #include "rasterclassification.h"
@@ -29,8 +30,7 @@ bool RasterClassification::execute(ExecutionContext *ctx, SymbolTable &symTable)
         if((_prepState = prepare(ctx,symTable)) != sPREPARED)
             return false;
 
-    PixelIterator iterIn(_sampleSet.sampleRasterSet());
-    iterIn.setFlow(PixelIterator::fZXY);
+    BandVectorIterator iterIn(_sampleSet.sampleRasterSet());
 
     PixelIterator iterOut(_outputRaster);
 
@@ -147,3 +147,114 @@ quint64 BoxClassification::createMetadata()
     return operation.id();
 }
 
+//-------------------------------------------------------
+namespace {
+// a missing threshold or one of 0 or less means that every pixel is assigned to its nearest class
+bool threshold(const Ilwis::OperationExpression& expr, double& value) {
+    value = rUNDEF;
+    if ( expr.parameterCount() < 4)
+        return true;
+    bool ok;
+    value = expr.parm(3).value().toDouble(&ok);
+    if ( ok && value <= 0)
+        value = rUNDEF;
+    return ok;
+}
+}
+
+REGISTER_OPERATION(MinDistClassification)
+
+MinDistClassification::MinDistClassification(quint64 metaid, const Ilwis::OperationExpression &expr) : RasterClassification(metaid, expr)
+{
+
+}
+
+Ilwis::OperationImplementation *MinDistClassification::create(quint64 metaid, const Ilwis::OperationExpression &expr)
+{
+    return new MinDistClassification(metaid, expr);
+}
+
+Ilwis::OperationImplementation::State MinDistClassification::prepare(ExecutionContext *ctx, const SymbolTable &sym)
+{
+    OperationImplementation::State prepareState = sNOTPREPARED;
+
+    if ( (prepareState = RasterClassification::prepare(ctx,sym)) != sPREPARED){
+        return prepareState;
+    }
+
+    if (!threshold(_expression, _threshold)){
+        ERROR2(ERR_ILLEGAL_VALUE_2, "threshold distance", _expression.parm(3).value());
+        return sPREPAREFAILED;
+    }
+
+    _classifier.reset( new MinDistClassifier(_threshold,_sampleSet));
+    if(!_classifier->prepare())
+        return sPREPAREFAILED;
+
+    return sPREPARED;
+}
+
+quint64 MinDistClassification::createMetadata()
+{
+    OperationResource operation({"ilwis://operations/mindistclassification"});
+    operation.setSyntax("mindistclassification(multibandraster,thematicdomain,trainingraster,threshold-distance)");
+    operation.setDescription(TR("performs a multi-spectral image classification, assigning every pixel to the class with the nearest mean"));
+    unsigned int n = RasterClassification::fillOperationMetadata(operation);
+    operation.setInParameterCount({n, 1 + n});
+    operation.addInParameter(n,itNUMBER , TR("threshold-distance"),TR("pixels farther than this distance from every class mean stay unclassified; 0 means no threshold"));
+    operation.setOutParameterCount({1});
+    operation.addOutParameter(0,itRASTER, TR("output rastercoverage with the domain of the sampleset"));
+    operation.setKeywords("classification,raster");
+
+    mastercatalog()->addItems({operation});
+    return operation.id();
+}
+
+//-------------------------------------------------------
+REGISTER_OPERATION(MaxLikelihoodClassification)
+
+MaxLikelihoodClassification::MaxLikelihoodClassification(quint64 metaid, const Ilwis::OperationExpression &expr) : RasterClassification(metaid, expr)
+{
+
+}
+
+Ilwis::OperationImplementation *MaxLikelihoodClassification::create(quint64 metaid, const Ilwis::OperationExpression &expr)
+{
+    return new MaxLikelihoodClassification(metaid, expr);
+}
+
+Ilwis::OperationImplementation::State MaxLikelihoodClassification::prepare(ExecutionContext *ctx, const SymbolTable &sym)
+{
+    OperationImplementation::State prepareState = sNOTPREPARED;
+
+    if ( (prepareState = RasterClassification::prepare(ctx,sym)) != sPREPARED){
+        return prepareState;
+    }
+
+    if (!threshold(_expression, _threshold)){
+        ERROR2(ERR_ILLEGAL_VALUE_2, "threshold distance", _expression.parm(3).value());
+        return sPREPAREFAILED;
+    }
+
+    _classifier.reset( new MaxLikelihoodClassifier(_threshold,_sampleSet));
+    if(!_classifier->prepare())
+        return sPREPAREFAILED;
+
+    return sPREPARED;
+}
+
+quint64 MaxLikelihoodClassification::createMetadata()
+{
+    OperationResource operation({"ilwis://operations/maxlikelihoodclassification"});
+    operation.setSyntax("maxlikelihoodclassification(multibandraster,thematicdomain,trainingraster,threshold-distance)");
+    operation.setDescription(TR("performs a multi-spectral image classification, assigning every pixel to the class it most likely belongs to"));
+    unsigned int n = RasterClassification::fillOperationMetadata(operation);
+    operation.setInParameterCount({n, 1 + n});
+    operation.addInParameter(n,itNUMBER , TR("threshold-distance"),TR("pixels with a larger (mahalanobis) distance to every class stay unclassified; 0 means no threshold"));
+    operation.setOutParameterCount({1});
+    operation.addOutParameter(0,itRASTER, TR("output rastercoverage with the domain of the sampleset"));
+    operation.setKeywords("classification,raster");
+
+    mastercatalog()->addItems({operation});
+    return operation.id();
+}
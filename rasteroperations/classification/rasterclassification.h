@@ -38,6 +38,36 @@ public:
 private:
     double _widenFactor;
 };
+
+class MinDistClassification : public RasterClassification {
+public:
+    MinDistClassification(quint64 metaid, const Ilwis::OperationExpression &expr);
+
+    static Ilwis::OperationImplementation *create(quint64 metaid,const Ilwis::OperationExpression& expr);
+    Ilwis::OperationImplementation::State prepare(ExecutionContext *ctx, const SymbolTable &sym);
+
+    static quint64 createMetadata();
+
+    NEW_OPERATION(MinDistClassification);
+
+private:
+    double _threshold = rUNDEF;
+};
+
+class MaxLikelihoodClassification : public RasterClassification {
+public:
+    MaxLikelihoodClassification(quint64 metaid, const Ilwis::OperationExpression &expr);
+
+    static Ilwis::OperationImplementation *create(quint64 metaid,const Ilwis::OperationExpression& expr);
+    Ilwis::OperationImplementation::State prepare(ExecutionContext *ctx, const SymbolTable &sym);
+
+    static quint64 createMetadata();
+
+    NEW_OPERATION(MaxLikelihoodClassification);
+
+private:
+    double _threshold = rUNDEF;
+};
 }
 }
 
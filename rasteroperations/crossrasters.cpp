@@ -1,5 +1,6 @@
 #include <functional>
 #include <future>
+#include <algorithm>
 #include "kernel.h"
 #include "raster.h"
 #include "columndefinition.h"
@@ -28,116 +29,181 @@ CrossRasters::CrossRasters(quint64 metaid, const Ilwis::OperationExpression &exp
 #define SHIFTER 10e8
 const unsigned int MAGIC_NUMBER = 300000;
 
-struct Combo {
-    Combo(quint32 id=iUNDEF, quint32 count=0) : _id(id), _count(count) {}
-    quint32 _id;
-    quint32 _count;
-};
+const quint64 ComboTable::EMPTY;
 
-bool CrossRasters::crossWithRaster(const  BoundingBox& box){
+ComboTable::ComboTable(quint32 capacity)
+{
+    quint32 size = 16;
+    while(size < capacity)
+        size *= 2;
+    _combos.resize(size, EMPTY);
+    _values.resize(size, 0);
+    _mask = size - 1;
+}
+
+quint32 ComboTable::slot(quint64 combo) const
+{
+    quint32 index = (combo * 0x9E3779B97F4A7C15ULL) >> 32; // fibonacci hashing, the raws differ mostly in the low bits
+    while(true) {
+        index &= _mask;
+        if ( _combos[index] == combo || _combos[index] == EMPTY)
+            return index;
+        ++index;
+    }
+}
+
+void ComboTable::grow()
+{
+    std::vector<quint64> combos(_combos.size() * 2, EMPTY);
+    std::vector<quint64> values(_values.size() * 2, 0);
+    std::swap(combos, _combos);
+    std::swap(values, _values);
+    _mask = _combos.size() - 1;
+    for(quint32 i = 0; i < combos.size(); ++i) {
+        if ( combos[i] == EMPTY)
+            continue;
+        quint32 index = slot(combos[i]);
+        _combos[index] = combos[i];
+        _values[index] = values[i];
+    }
+}
+
+quint64 &ComboTable::operator[](quint64 combo)
+{
+    quint32 index = slot(combo);
+    if ( _combos[index] == EMPTY) {
+        if ( (_size + 1) * 2 > _combos.size()) { // keep the load under a half, probe sequences stay short
+            grow();
+            index = slot(combo);
+        }
+        _combos[index] = combo;
+        ++_size;
+    }
+    return _values[index];
+}
+
+quint64 ComboTable::value(quint64 combo) const
+{
+    quint32 index = slot(combo);
+    return _combos[index] == EMPTY ? iUNDEF : _values[index];
+}
+
+quint32 ComboTable::size() const
+{
+    return _size;
+}
+
+void ComboTable::merge(const ComboTable &table)
+{
+    for(quint32 i = 0; i < table._combos.size(); ++i) {
+        if ( table._combos[i] != EMPTY)
+            (*this)[table._combos[i]] += table._values[i];
+    }
+}
+
+std::vector<std::pair<quint64, quint64> > ComboTable::sorted() const
+{
+    std::vector<std::pair<quint64, quint64>> entries;
+    entries.reserve(_size);
+    for(quint32 i = 0; i < _combos.size(); ++i) {
+        if ( _combos[i] != EMPTY)
+            entries.push_back(std::pair<quint64, quint64>(_combos[i], _values[i]));
+    }
+    std::sort(entries.begin(), entries.end());
+    return entries;
+}
+
+//-------------------------------------------------------
+bool CrossRasters::combine(double v1, double v2, quint64 &combo) const
+{
+    if ( isNumericalUndef(v1) )
+        v1 = MAGIC_NUMBER;
+    if ( isNumericalUndef(v2) )
+        v2 = MAGIC_NUMBER;
+    if ( _undefhandling == uhIgnoreUndef && (v1 == MAGIC_NUMBER || v2 == MAGIC_NUMBER))
+        return false;
+
+    combo = v1 + v2 * SHIFTER;
+    return true;
+}
+
+QString CrossRasters::comboName(quint32 v1, quint32 v2) const
+{
+    QString elem1 = _inputRaster1->datadef().domain<>()->impliedValue(v1).toString();
+    QString elem2 = _inputRaster2->datadef().domain<>()->impliedValue(v2).toString();
+    if ( _undefhandling == uhIgnoreUndef1 && v1 == MAGIC_NUMBER)
+        return elem2;
+    if ( _undefhandling == uhIgnoreUndef2 && v2 == MAGIC_NUMBER)
+        return elem1;
+    return QString("%1 * %2").arg(elem1).arg(elem2);
+}
+
+bool CrossRasters::countCombos(const BoundingBox &box, ComboTable &counts) const
+{
     PixelIterator iterIn1(_inputRaster1, box);
     PixelIterator iterIn2(_inputRaster2, box);
-    PixelIterator iterOut(_outputRaster, box);
-    quint32 idcount = 0;
-    std::map<quint64, Combo> combos;
-    std::for_each(iterIn1, iterIn1.end(), [&](double v1){
-        double v2 = *iterIn2;
-        if ( isNumericalUndef(v1) )
-            v1 = MAGIC_NUMBER;
-        if ( isNumericalUndef(v2) )
-            v2 = MAGIC_NUMBER;
-
-        bool ignore = (_undefhandling == uhIgnoreUndef ) && (v1 == MAGIC_NUMBER || v1 == MAGIC_NUMBER);
-
-        if (!ignore) {
-            quint64 combo = v1 + v2 * SHIFTER;
-            auto iterCombos = combos.find(combo);
-            if ( iterCombos == combos.end()){
-                combos[combo]._count = 1;
-                combos[combo]._id = idcount;
-                *iterOut = idcount;
-                ++idcount;
-            }
-            else{
-                (*(iterCombos)).second._count++;
-                *iterOut = (*(iterCombos)).second._id;
-            }
-        }
-        ++iterIn2;
-        ++iterOut;
-    });
-    quint32 record = 0;
-    NamedIdentifierRange *idrange = new NamedIdentifierRange();
-    for(auto element : combos) {
-        quint64 combo = element.first;
-        quint32 v2 = combo / SHIFTER;
-        quint32 v1 = combo  - v2 * SHIFTER;
-        QString elem1 = _inputRaster1->datadef().domain<>()->impliedValue(v1).toString();
-        QString elem2 = _inputRaster2->datadef().domain<>()->impliedValue(v2).toString();
-        QString id = QString("%1 * %2").arg(elem1).arg(elem2);;
-        switch (_undefhandling){
-        case uhIgnoreUndef:
-            if (v1 == MAGIC_NUMBER || v1 == MAGIC_NUMBER)
-                id = "";
-            break;
-        case uhIgnoreUndef1:
-            if (v1 == MAGIC_NUMBER)
-                id = elem2;
-            break;
-        case uhIgnoreUndef2:
-            if (v2 == MAGIC_NUMBER)
-                id = elem1;
+    PixelIterator iterEnd = iterIn1.end();
+    // neighbouring pixels mostly have the same combination; counting runs saves most of the lookups
+    quint64 runCombo = ComboTable::EMPTY;
+    quint64 runLength = 0;
+    while(iterIn1 != iterEnd) {
+        auto in1 = iterIn1.span();
+        auto in2 = iterIn2.span();
+        qint64 cells = std::min(in1.second - in1.first, in2.second - in2.first);
+        if ( cells == 0)
             break;
-        default:
-            break;
-        }
-        if (id != ""){
-            idrange->add(new NamedIdentifier(id, element.second._id ));
-            _outputTable->setCell(0,record,QVariant(record));
-            _outputTable->setCell(1,record,QVariant(v1));
-            _outputTable->setCell(2,record,QVariant(v2));
-            Combo& cm = element.second;
-            _outputTable->setCell(3,record,QVariant(cm._count))          ;
-            ++record;
+        for(qint64 i = 0; i < cells; ++i) {
+            quint64 combo;
+            if (!combine(in1.first[i], in2.first[i], combo))
+                continue;
+            if ( combo != runCombo) {
+                if ( runLength > 0)
+                    counts[runCombo] += runLength;
+                runCombo = combo;
+                runLength = 0;
+            }
+            ++runLength;
         }
+        iterIn1 += cells;
+        iterIn2 += cells;
     }
-    _crossDomain->range(idrange);
+    if ( runLength > 0)
+        counts[runCombo] += runLength;
 
     return true;
 }
 
-bool CrossRasters::crossNoRaster( const BoundingBox& box){
+bool CrossRasters::writeCombos(const BoundingBox &box, const ComboTable &ids)
+{
     PixelIterator iterIn1(_inputRaster1, box);
     PixelIterator iterIn2(_inputRaster2, box);
-    std::map<quint64, quint64> combos;
-    std::for_each(iterIn1, iterIn1.end(), [&](double& v1){
-        qint32 v2 = *iterIn2;
-        quint64 combo = v1 + v2 * SHIFTER;
-        auto iterCombos = combos.find(combo);
-        if ( iterCombos == combos.end())
-            combos[combo] = 1;
-        else
-            (*(iterCombos)).second++;
-        ++iterIn2;
-    });
-    quint32 record = 0;
-    NamedIdentifierRange *idrange = new NamedIdentifierRange();
-    for(auto element : combos) {
-        quint64 combo = element.first;
-        quint32 v2 = combo / SHIFTER;
-        quint32 v1 = combo  - v2 * SHIFTER;
-        QString id = QString("%1 * %2").arg(_inputRaster1->datadef().domain<>()->impliedValue(v1).toString()).
-                arg(_inputRaster2->datadef().domain<>()->impliedValue(v2).toString());
-        *idrange << id;
-        _outputTable->setCell(0,record,QVariant(record));
-        _outputTable->setCell(1,record,QVariant(v1));
-        _outputTable->setCell(2,record,QVariant(v2));
-        Combo cm = element.second;
-        _outputTable->setCell(3,record,QVariant(cm._count))        ;
-        ++record;
+    PixelIterator iterOut(_outputRaster, box);
+    PixelIterator iterEnd = iterOut.end();
+    quint64 lastCombo = ComboTable::EMPTY;
+    double lastId = rUNDEF;
+    while(iterOut != iterEnd) {
+        auto in1 = iterIn1.span();
+        auto in2 = iterIn2.span();
+        auto out = iterOut.span();
+        qint64 cells = std::min(std::min(in1.second - in1.first, in2.second - in2.first), out.second - out.first);
+        if ( cells == 0)
+            break;
+        for(qint64 i = 0; i < cells; ++i) {
+            quint64 combo;
+            if (!combine(in1.first[i], in2.first[i], combo)) {
+                out.first[i] = rUNDEF;
+                continue;
+            }
+            if ( combo != lastCombo) {
+                lastCombo = combo;
+                lastId = ids.value(combo);
+            }
+            out.first[i] = lastId;
+        }
+        iterIn1 += cells;
+        iterIn2 += cells;
+        iterOut += cells;
     }
-    _crossDomain->range(idrange);
-
     return true;
 }
 
@@ -153,11 +219,52 @@ bool CrossRasters::execute(ExecutionContext *ctx, SymbolTable &symTable)
         }
     }
 
-    bool ok;
-    if ( _outputRaster.isValid())
-        ok = crossWithRaster(_inputRaster1->size());
-    else
-        ok = crossNoRaster(_inputRaster1->size());
+    std::vector<BoundingBox> tiles;
+    int cores = OperationHelperRaster::subdivideTasks(ctx, _inputRaster1, BoundingBox(), tiles);
+    if ( cores == iUNDEF)
+        return false;
+
+    // first pass: every tile counts its combinations in its own table
+    std::map<qint32, quint32> tileIndex;
+    for(quint32 i = 0; i < tiles.size(); ++i)
+        tileIndex[tiles[i].min_corner().y] = i;
+    std::vector<ComboTable> tileCounts(tiles.size());
+    BoxedAsyncFunc countFun = [&](const BoundingBox& box) -> bool {
+        return countCombos(box, tileCounts[tileIndex[box.min_corner().y]]);
+    };
+    bool ok = tilescheduler()->execute(tiles, cores, countFun, ctx);
+    if (!ok)
+        return false;
+
+    // merge in tile order and number the combinations in sorted order, so the ids never depend on the threads
+    ComboTable counts;
+    for(const ComboTable& tileTable : tileCounts)
+        counts.merge(tileTable);
+    tileCounts.clear();
+    std::vector<std::pair<quint64, quint64>> combos = counts.sorted();
+
+    ComboTable ids(combos.size() * 2);
+    NamedIdentifierRange *idrange = new NamedIdentifierRange();
+    for(quint32 record = 0; record < combos.size(); ++record) {
+        quint64 combo = combos[record].first;
+        quint32 v2 = combo / SHIFTER;
+        quint32 v1 = combo  - v2 * SHIFTER;
+        ids[combo] = record;
+        idrange->add(new NamedIdentifier(comboName(v1, v2), record));
+        _outputTable->setCell(0,record,QVariant(record));
+        _outputTable->setCell(1,record,QVariant(v1));
+        _outputTable->setCell(2,record,QVariant(v2));
+        _outputTable->setCell(3,record,QVariant(combos[record].second));
+    }
+    _crossDomain->range(idrange);
+
+    // second pass: write the combination ids
+    if ( _outputRaster.isValid()) {
+        BoxedAsyncFunc writeFun = [&](const BoundingBox& box) -> bool {
+            return writeCombos(box, ids);
+        };
+        ok = tilescheduler()->execute(tiles, cores, writeFun, ctx);
+    }
 
     if ( ok && ctx != 0) {
         QVariant value;
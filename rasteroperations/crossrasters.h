@@ -4,6 +4,35 @@
 namespace Ilwis {
 namespace RasterOperations {
 
+/*!
+ * \brief The ComboTable class is an open addressing hash table (linear probing) from a combination of two raw values to a number
+ *
+ * Crossing counts every pixel, so the lookup is on the hot path; a flat table keeps a lookup to (usually) one multiplication and one
+ * cache line instead of the tree walk of a std::map. Each tile gets its own table so that tiles can be counted in parallel; the tables are
+ * merged afterwards in tile order (see CrossRasters::execute), which makes the result independent of the thread scheduling.
+ */
+class ComboTable {
+public:
+    ComboTable(quint32 capacity=64);
+
+    quint64& operator[](quint64 combo);
+    quint64 value(quint64 combo) const;
+    quint32 size() const;
+    void merge(const ComboTable& table);
+    std::vector<std::pair<quint64, quint64>> sorted() const;
+
+    static const quint64 EMPTY = 0xFFFFFFFFFFFFFFFFULL; // not a valid combination, the raws are far smaller than the shifter
+
+private:
+    quint32 slot(quint64 combo) const;
+    void grow();
+
+    std::vector<quint64> _combos;
+    std::vector<quint64> _values;
+    quint32 _mask;
+    quint32 _size = 0;
+};
+
 
 class CrossRasters : public OperationImplementation
 {
@@ -27,8 +56,10 @@ private:
     INamedIdDomain _crossDomain;
     UndefHandling _undefhandling;
 
-    bool crossNoRaster(const BoundingBox& box);
-    bool crossWithRaster(const  BoundingBox& box);
+    bool combine(double v1, double v2, quint64& combo) const;
+    QString comboName(quint32 v1, quint32 v2) const;
+    bool countCombos(const BoundingBox& box, ComboTable& counts) const;
+    bool writeCombos(const BoundingBox& box, const ComboTable& ids);
 };
 }
 }
@@ -20,7 +20,7 @@ public:
 private:
     IRasterCoverage _inputRaster;
     IRasterCoverage _outputRaster;
-    std::unique_ptr<RasterFilter> _filter;
+    std::unique_ptr<LinearGridFilter> _filter;
 
     NEW_OPERATION(LinearRasterFilter);
 };
@@ -32,14 +32,30 @@ bool RankOrderRasterFilter::execute(ExecutionContext *ctx, SymbolTable &symTable
         if((_prepState = prepare(ctx,symTable)) != sPREPARED)
             return false;
 
-   BoxedAsyncFunc filterFun = [&](const BoundingBox& box) -> bool {
+    // a window per tile and band; it keeps its line buffers and histograms from one output line to the next (see RankOrderWindow)
+    BoxedStatisticsFunc filterFun = [&](const BoundingBox& box, NumericStatistics::Partial& markers) -> bool {
         PixelIterator iterOut(_outputRaster, box);
-        BlockIterator blockIter(_inputRaster,_filter->size(), box, Size<>(1,1,1));
         PixelIterator iterEnd = iterOut.end();
-        while(iterOut != iterEnd) {
-            *iterOut = _filter->applyTo(*blockIter);
-            ++iterOut;
-            ++blockIter;
+        std::vector<double> result(_inputRaster->size().xsize());
+        qint32 zmax = std::min((qint32)box.max_corner().z, (qint32)_inputRaster->size().zsize() - 1);
+        for(qint32 z = box.min_corner().z; z <= zmax; ++z) {
+            RankOrderWindow window(_inputRaster, _filter->size(), _filter->index(), z);
+            for(qint32 y = box.min_corner().y; y <= box.max_corner().y && iterOut != iterEnd; ++y) {
+                window.applyTo(y, &result[0]);
+                const double *values = &result[box.min_corner().x];
+                qint64 todo = box.xlength();
+                while(todo > 0) {
+                    auto out = iterOut.span();
+                    qint64 cells = std::min(todo, (qint64)(out.second - out.first));
+                    if ( cells == 0)
+                        return false;
+                    std::copy(values, values + cells, out.first);
+                    std::for_each(out.first, out.first + cells, std::ref(markers));
+                    values += cells;
+                    todo -= cells;
+                    iterOut += cells;
+                }
+            }
         }
         return true;
     };